@@ -0,0 +1,45 @@
+option(FETCHCONTENT_UPDATES_DISCONNECTED TRUE)
+option(FETCHCONTENT_QUIET FALSE)
+include(FetchContent)
+
+set(BENCHMARK_ENABLE_TESTING OFF CACHE INTERNAL "")
+set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE INTERNAL "")
+set(BENCHMARK_ENABLE_INSTALL OFF CACHE INTERNAL "")
+
+FetchContent_Declare(benchmark
+  GIT_REPOSITORY "https://github.com/google/benchmark"
+  GIT_TAG        v1.9.1
+  GIT_PROGRESS   TRUE
+  EXCLUDE_FROM_ALL
+  FIND_PACKAGE_ARGS
+    NAMES benchmark
+)
+FetchContent_MakeAvailable(benchmark)
+
+add_executable(json-tui-bench
+  src/document_benchmark.cpp
+  src/json_generator.cpp
+  src/json_generator.hpp
+  src/main_ui_benchmark.cpp
+  src/structural_scanner_benchmark.cpp
+)
+
+target_link_libraries(json-tui-bench
+  PRIVATE json-tui-lib
+  PRIVATE benchmark::benchmark_main
+)
+target_include_directories(json-tui-bench
+  PRIVATE src
+)
+target_compile_features(json-tui-bench PUBLIC cxx_std_17)
+
+# Run every benchmark, and write the results to benchmark.json, so that they
+# can be compared across versions. Select a subset with:
+#   json-tui-bench --benchmark_filter=<regex>
+add_custom_target(json-tui-bench-json
+  COMMAND json-tui-bench
+    --benchmark_out=${CMAKE_CURRENT_BINARY_DIR}/benchmark.json
+    --benchmark_out_format=json
+  DEPENDS json-tui-bench
+  USES_TERMINAL
+)
@@ -23,7 +23,23 @@ if(NOT googletest_POPULATED)
 endif()
 
 add_executable(tests
+  src/document_test.cpp
   src/expander_test.cpp
+  src/filter_test.cpp
+  src/followed_file_test.cpp
+  src/index_cache_test.cpp
+  src/json_generator.cpp
+  src/json_generator_test.cpp
+  src/json_lines_test.cpp
+  src/json_pointer_test.cpp
+  src/key_table_test.cpp
+  src/long_string_test.cpp
+  src/main_ui_test.cpp
+  src/printer_test.cpp
+  src/search_index_test.cpp
+  src/stats_test.cpp
+  src/stream_parser_test.cpp
+  src/structural_scanner_test.cpp
 )
 
 target_link_libraries(tests
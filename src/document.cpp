@@ -0,0 +1,1210 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+
+#include "document.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <thread>
+
+#include "structural_scanner.hpp"
+
+namespace {
+
+bool IsWhitespace(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+bool IsDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+int HexValue(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+// Read the 4 hexadecimal digits of a \uXXXX escape sequence. Return -1 when
+// they are invalid.
+int ReadHex4(std::string_view input, size_t position) {
+  if (position + 4 > input.size())
+    return -1;
+  int value = 0;
+  for (size_t i = position; i < position + 4; ++i) {
+    int digit = HexValue(input[i]);
+    if (digit < 0)
+      return -1;
+    value = value * 16 + digit;
+  }
+  return value;
+}
+
+void AppendUTF8(uint32_t codepoint, std::string& out) {
+  if (codepoint < 0x80) {
+    out += static_cast<char>(codepoint);
+  } else if (codepoint < 0x800) {
+    out += static_cast<char>(0xC0 | (codepoint >> 6));
+    out += static_cast<char>(0x80 | (codepoint & 0x3F));
+  } else if (codepoint < 0x10000) {
+    out += static_cast<char>(0xE0 | (codepoint >> 12));
+    out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (codepoint & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (codepoint >> 18));
+    out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (codepoint & 0x3F));
+  }
+}
+
+// Return the length of the UTF-8 sequence starting at |position|, or 0 when
+// it is invalid.
+size_t UTF8Length(std::string_view input, size_t position) {
+  auto byte = [&](size_t i) -> uint8_t {
+    return i < input.size() ? static_cast<uint8_t>(input[i]) : 0;
+  };
+  auto in = [](uint8_t value, uint8_t min, uint8_t max) {
+    return value >= min && value <= max;
+  };
+  const uint8_t b0 = byte(position);
+  const uint8_t b1 = byte(position + 1);
+  const uint8_t b2 = byte(position + 2);
+  const uint8_t b3 = byte(position + 3);
+  if (b0 < 0x80)
+    return 1;
+  if (in(b0, 0xC2, 0xDF))
+    return in(b1, 0x80, 0xBF) ? 2 : 0;
+  if (in(b0, 0xE0, 0xEF)) {
+    const uint8_t min = b0 == 0xE0 ? 0xA0 : 0x80;
+    const uint8_t max = b0 == 0xED ? 0x9F : 0xBF;
+    return in(b1, min, max) && in(b2, 0x80, 0xBF) ? 3 : 0;
+  }
+  if (in(b0, 0xF0, 0xF4)) {
+    const uint8_t min = b0 == 0xF0 ? 0x90 : 0x80;
+    const uint8_t max = b0 == 0xF4 ? 0x8F : 0xBF;
+    return in(b1, min, max) && in(b2, 0x80, 0xBF) && in(b3, 0x80, 0xBF) ? 4
+                                                                        : 0;
+  }
+  return 0;
+}
+
+// Whether the valid JSON number |text| is at least 1 in magnitude, from the
+// position of its first significant digit. It must not be zero.
+bool IsLarge(std::string_view text) {
+  const size_t exponent_begin = text.find_first_of("eE");
+  const std::string_view mantissa = text.substr(0, exponent_begin);
+  const size_t point = std::min(mantissa.find('.'), mantissa.size());
+  const size_t first = mantissa.find_first_of("123456789");
+  // The power of ten of the first significant digit, without the exponent.
+  int64_t power = first < point ? static_cast<int64_t>(point - first - 1)
+                                : -static_cast<int64_t>(first - point);
+
+  // The exponent saturates: the mantissa of a number is never this long.
+  int64_t exponent = 0;
+  if (exponent_begin != std::string_view::npos) {
+    size_t i = exponent_begin + 1;
+    const bool negative = text[i] == '-';
+    if (text[i] == '-' || text[i] == '+')
+      i++;
+    for (; i < text.size() && exponent < (int64_t{1} << 40); ++i)
+      exponent = 10 * exponent + (text[i] - '0');
+    if (negative)
+      exponent = -exponent;
+  }
+  power += exponent;
+  return power >= 0;
+}
+
+}  // namespace
+
+// Build the tape in a single pass, without recursion.
+//
+// The children of the open containers are accumulated in |pending_|. When a
+// container is closed, its children are moved to the tape as a contiguous
+// block.
+//
+// When a structural index is given, only the children of the outermost
+// container are parsed. The nested containers are skipped, and marked as
+// unloaded.
+//
+// A chunk of the elements of the root array can also be parsed alone. See
+// RunChunk().
+class Document::Parser {
+ public:
+  Parser(std::string_view input,
+         std::vector<Node>& tape,
+         const Index* containers = nullptr,
+         Progress* progress = nullptr)
+      : input_(input),
+        tape_(tape),
+        containers_(containers),
+        progress_(progress) {}
+
+  // Parse the whole input.
+  bool Run() {
+    tape_.clear();
+    tape_.emplace_back();  // The root, written last.
+
+    Node root;
+    SkipWhitespace();
+    next_container_ = 1;  // The root is the first container.
+    if (!ParseValue(root, kRoot) || !ParseContainers(root))
+      return false;
+    Report();
+
+    SkipWhitespace();
+    if (position_ != input_.size())
+      return Fail("unexpected character after the end of the document");
+
+    tape_[0] = root;
+    return true;
+  }
+
+  // Parse the children of an unloaded container.
+  bool Load(Node& node) {
+    position_ = node.offset;
+    next_container_ = node.first_child + 1;
+    node.flags &= ~kUnloaded;
+    return ParseValue(node, kRoot) && ParseContainers(node);
+  }
+
+  // Parse the elements of the root array from |begin| to |end|, where the
+  // next chunk begins. The nested containers are written to the tape, and the
+  // elements themselves to |elements|. Their children are indexed from the
+  // beginning of the tape. The first chunk begins with the root's bracket,
+  // the others after a comma. The last one, with |end| = npos, ends with the
+  // document.
+  bool RunChunk(size_t begin,
+                size_t end,
+                bool first,
+                std::vector<Node>& elements) {
+    tape_.clear();
+    chunk_ = true;
+    stop_ = end;
+    position_ = begin;
+    reported_position_ = begin;
+    Node root;
+    if (containers_) {
+      next_container_ =
+          std::lower_bound(containers_->begin(), containers_->end(),
+                           begin + (first ? 1 : 0),
+                           [](const Container& container, size_t position) {
+                             return container.begin < position;
+                           }) -
+          containers_->begin();
+    }
+    if (first) {
+      if (!ParseValue(root, kRoot))
+        return false;
+    } else {
+      stack_.push_back({kRoot, 0, /*object=*/false, State::Value});
+    }
+    if (!ParseContainers(root))
+      return false;
+    Report();
+    elements = std::move(pending_);
+
+    if (end != std::string_view::npos)
+      return true;
+    SkipWhitespace();
+    if (position_ != input_.size())
+      return Fail("unexpected character after the end of the document");
+    return true;
+  }
+
+  // The position of the error in the input.
+  size_t position() const { return position_; }
+  const std::string& error() const { return error_; }
+
+ private:
+  static constexpr size_t kRoot = std::numeric_limits<size_t>::max();
+  // The progress is reported about every this many bytes.
+  static constexpr size_t kReportSpacing = 1 << 20;
+
+  enum class State {
+    ValueOrClose,  // After the opening bracket.
+    Value,         // After a comma.
+    CommaOrClose,  // After a value.
+  };
+
+  struct Frame {
+    size_t node;      // Index in |pending_|, or kRoot.
+    size_t children;  // Index of the first child in |pending_|.
+    bool object;
+    State state;
+  };
+
+  // Parse until every open container is closed.
+  bool ParseContainers(Node& root) {
+    while (!stack_.empty()) {
+      SkipWhitespace();
+
+      if (progress_ && position_ >= next_report_) {
+        if (progress_->cancel)
+          return Fail("cancelled");
+        Report();
+      }
+
+      // The next chunk begins here. It must be where an element of the root
+      // array is expected, otherwise it was split at the wrong place.
+      if (stack_.size() == 1 && position_ >= stop_) {
+        if (position_ != stop_ || stack_.back().state == State::CommaOrClose)
+          return Fail("the chunk doesn't end where the next one begins");
+        return true;
+      }
+
+      if (position_ >= input_.size())
+        return Fail("unexpected end of input");
+
+      const char c = input_[position_];
+      const bool object = stack_.back().object;
+      const State state = stack_.back().state;
+
+      // End of the container:
+      if (c == (object ? '}' : ']') && state != State::Value) {
+        // The elements of a chunk are stitched by the caller.
+        if (chunk_ && stack_.size() == 1) {
+          stack_.pop_back();
+          position_++;
+          return true;
+        }
+        if (!Close(root))
+          return false;
+        continue;
+      }
+
+      if (state == State::CommaOrClose) {
+        if (c != ',')
+          return Fail(object ? "expected ',' or '}'" : "expected ',' or ']'");
+        position_++;
+        stack_.back().state = State::Value;
+        continue;
+      }
+
+      Node child;
+      if (object) {
+        const size_t key = position_;
+        if (c != '"')
+          return Fail("expected a string as the member key");
+        bool escaped = false;
+        if (!ParseString(escaped))
+          return false;
+        SkipWhitespace();
+        if (position_ >= input_.size() || input_[position_] != ':')
+          return Fail("expected ':'");
+        position_++;
+        SkipWhitespace();
+        if (position_ - key > std::numeric_limits<uint32_t>::max())
+          return Fail("the member key is too long");
+        child.key_offset = static_cast<uint32_t>(position_ - key);
+        child.flags = escaped ? kKeyEscaped : 0;
+      }
+
+      stack_.back().state = State::CommaOrClose;
+      pending_.push_back(child);
+      if (!ParseValue(pending_.back(), pending_.size() - 1))
+        return false;
+    }
+    return true;
+  }
+
+  // Add what was parsed since the last report to |progress_|. Several parsers
+  // can share it.
+  void Report() {
+    if (!progress_)
+      return;
+    const size_t nodes = tape_.size() + pending_.size();
+    progress_->parsed += position_ - reported_position_;
+    progress_->nodes += nodes - reported_nodes_;
+    reported_position_ = position_;
+    reported_nodes_ = nodes;
+    next_report_ = position_ + kReportSpacing;
+  }
+
+  void SkipWhitespace() {
+    while (position_ < input_.size() && IsWhitespace(input_[position_]))
+      position_++;
+  }
+
+  bool Fail(const char* message) {
+    error_ = message;
+    return false;
+  }
+
+  // Parse the value at the current position. Scalars are complete on return.
+  // Containers are completed by Close().
+  bool ParseValue(Node& node, size_t index) {
+    if (position_ >= input_.size())
+      return Fail("unexpected end of input; expected a value");
+
+    node.offset = position_;
+    switch (input_[position_]) {
+      case '{':
+      case '[': {
+        const bool object = input_[position_] == '{';
+        node.type = object ? Type::Object : Type::Array;
+        if (containers_ && !stack_.empty())
+          return Skip(node);
+        position_++;
+        stack_.push_back({index, pending_.size(), object, State::ValueOrClose});
+        return true;
+      }
+
+      case '"': {
+        node.type = Type::String;
+        bool escaped = false;
+        if (!ParseString(escaped))
+          return false;
+        if (escaped)
+          node.flags |= kEscaped;
+        break;
+      }
+
+      case 't':
+        node.type = Type::True;
+        if (!ParseLiteral("true"))
+          return false;
+        break;
+
+      case 'f':
+        node.type = Type::False;
+        if (!ParseLiteral("false"))
+          return false;
+        break;
+
+      case 'n':
+        node.type = Type::Null;
+        if (!ParseLiteral("null"))
+          return false;
+        break;
+
+      default:
+        node.type = Type::Number;
+        if (!ParseNumber())
+          return false;
+        break;
+    }
+
+    if (position_ - node.offset > std::numeric_limits<uint32_t>::max())
+      return Fail("the value is too long");
+    node.size = static_cast<uint32_t>(position_ - node.offset);
+    return true;
+  }
+
+  // Skip a nested container, using the structural index. It will be parsed on
+  // demand.
+  bool Skip(Node& node) {
+    if (next_container_ >= containers_->size() ||
+        (*containers_)[next_container_].begin != position_) {
+      return Fail("invalid document structure");
+    }
+    const Container& container = (*containers_)[next_container_];
+    node.first_child = static_cast<uint32_t>(next_container_);
+    node.flags |= kUnloaded;
+    position_ = container.end + 1;
+    next_container_ = container.next;
+    return true;
+  }
+
+  // Move the children of the innermost container to the tape.
+  bool Close(Node& root) {
+    Frame frame = stack_.back();
+    stack_.pop_back();
+    position_++;
+
+    const size_t first = tape_.size();
+    const size_t count = pending_.size() - frame.children;
+    if (first + count > std::numeric_limits<uint32_t>::max())
+      return Fail("the document has too many nodes");
+    tape_.insert(tape_.end(), pending_.begin() + frame.children,
+                 pending_.end());
+    pending_.resize(frame.children);
+
+    Node& node = frame.node == kRoot ? root : pending_[frame.node];
+    node.first_child = static_cast<uint32_t>(first);
+    node.size = static_cast<uint32_t>(count);
+    return true;
+  }
+
+  bool ParseLiteral(std::string_view literal) {
+    if (input_.substr(position_, literal.size()) != literal)
+      return Fail("invalid literal");
+    position_ += literal.size();
+    return true;
+  }
+
+  bool ParseNumber() {
+    auto digits = [&] {
+      const size_t begin = position_;
+      while (position_ < input_.size() && IsDigit(input_[position_]))
+        position_++;
+      return position_ != begin;
+    };
+    auto accept = [&](char c) {
+      if (position_ < input_.size() && input_[position_] == c) {
+        position_++;
+        return true;
+      }
+      return false;
+    };
+
+    accept('-');
+    if (accept('0')) {
+      if (position_ < input_.size() && IsDigit(input_[position_]))
+        return Fail("invalid number; leading zeros are not allowed");
+    } else if (!digits()) {
+      return Fail("syntax error while parsing value");
+    }
+
+    if (accept('.') && !digits())
+      return Fail("invalid number; expected digit after '.'");
+
+    if (accept('e') || accept('E')) {
+      accept('+') || accept('-');
+      if (!digits())
+        return Fail("invalid number; expected digit after exponent");
+    }
+    return true;
+  }
+
+  bool ParseString(bool& escaped) {
+    position_++;  // Opening quote.
+    while (position_ < input_.size()) {
+      const char c = input_[position_];
+
+      if (c == '"') {
+        position_++;
+        return true;
+      }
+
+      if (c == '\\') {
+        escaped = true;
+        if (!ParseEscape())
+          return false;
+        continue;
+      }
+
+      if (static_cast<uint8_t>(c) < 0x20)
+        return Fail("control characters must be escaped");
+
+      const size_t length = UTF8Length(input_, position_);
+      if (length == 0)
+        return Fail("invalid UTF-8 byte");
+      position_ += length;
+    }
+    return Fail("unterminated string");
+  }
+
+  bool ParseEscape() {
+    position_++;  // Backslash.
+    if (position_ >= input_.size())
+      return Fail("unterminated string");
+
+    switch (input_[position_]) {
+      case '"':
+      case '\\':
+      case '/':
+      case 'b':
+      case 'f':
+      case 'n':
+      case 'r':
+      case 't':
+        position_++;
+        return true;
+
+      case 'u':
+        break;
+
+      default:
+        return Fail("invalid escape sequence");
+    }
+
+    const int codepoint = ReadHex4(input_, position_ + 1);
+    if (codepoint < 0)
+      return Fail("'\\u' must be followed by 4 hex digits");
+    position_ += 5;
+
+    if (codepoint >= 0xDC00 && codepoint <= 0xDFFF)
+      return Fail("invalid surrogate pair");
+
+    if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+      const bool is_escape = input_.substr(position_, 2) == "\\u";
+      const int low = is_escape ? ReadHex4(input_, position_ + 2) : -1;
+      if (low < 0xDC00 || low > 0xDFFF)
+        return Fail("invalid surrogate pair");
+      position_ += 6;
+    }
+    return true;
+  }
+
+  std::string_view input_;
+  std::vector<Node>& tape_;
+  const Index* containers_;
+  size_t next_container_ = 0;
+  std::vector<Node> pending_;
+  std::vector<Frame> stack_;
+  size_t position_ = 0;
+  std::string error_;
+
+  Progress* progress_;
+  size_t reported_position_ = 0;
+  size_t reported_nodes_ = 0;
+  size_t next_report_ = 0;
+
+  // RunChunk() only.
+  bool chunk_ = false;
+  size_t stop_ = std::string_view::npos;
+};
+
+namespace {
+
+Document::Parallelism Resolve(Document::Parallelism parallelism) {
+  if (parallelism.threads == 0)
+    parallelism.threads = std::max(1u, std::thread::hardware_concurrency());
+  parallelism.chunk_size = std::max<size_t>(parallelism.chunk_size, 1);
+  return parallelism;
+}
+
+// The structural index is built from parts of this many bytes, small enough
+// to stay in the cache while their brackets are matched.
+constexpr size_t kIndexPartSize = 1024 * kScanBlockSize;
+
+// The first comma of the root array in [from, limit), or npos. The range must
+// be outside of the nested containers. It can begin inside a string: the scan
+// resumes from the beginning of the part containing |from|.
+size_t FindRootComma(std::string_view input,
+                     const std::vector<ScanState>& parts,
+                     size_t from,
+                     size_t limit) {
+  constexpr size_t kStep = 64 * kScanBlockSize;
+  const size_t part = from / kIndexPartSize;
+  StructuralScanner scanner(parts[part]);
+  std::vector<uint64_t> brackets;
+  std::vector<uint64_t> commas;
+  for (size_t begin = part * kIndexPartSize; begin < limit; begin += kStep) {
+    commas.clear();
+    scanner.Scan(input.substr(begin, kStep), brackets, &commas);
+    for (const uint64_t comma : commas) {
+      if (comma >= limit)
+        return std::string_view::npos;
+      if (comma >= from)
+        return comma;
+    }
+  }
+  return std::string_view::npos;
+}
+
+// Where the chunks of the root array begin: its bracket, then an element about
+// every |chunk_size| bytes. The nested containers are skipped using the
+// structural |index|. Between them, the commas separating the elements are
+// found by scanning again from the |parts| of the index, so the commas inside
+// strings are ignored.
+template <typename Container>
+std::vector<size_t> ChunkBegins(std::string_view input,
+                                const std::vector<Container>& index,
+                                const std::vector<ScanState>& parts,
+                                size_t chunk_size) {
+  const Container& root = index[0];
+  std::vector<size_t> begins = {root.begin};
+  size_t child = 1;  // The next container of the root, if any.
+  auto has_child = [&] {
+    return child < index.size() && index[child].begin < root.end;
+  };
+  for (size_t target = root.begin + chunk_size; target < root.end;
+       target = begins.back() + chunk_size) {
+    while (has_child() && index[child].end < target)
+      child = index[child].next;
+    size_t from = target;
+    if (has_child() && index[child].begin <= target) {
+      from = index[child].end + 1;
+      child = index[child].next;
+    }
+
+    // Without a comma before it, the next container is the next element.
+    const size_t limit = has_child() ? index[child].begin : root.end;
+    const size_t comma = FindRootComma(input, parts, from, limit);
+    size_t begin = limit;
+    if (comma != std::string_view::npos) {
+      begin = comma + 1;
+      while (begin < limit && IsWhitespace(input[begin]))
+        begin++;
+    }
+    if (begin >= root.end)
+      break;
+    begins.push_back(begin);
+  }
+  return begins;
+}
+
+}  // namespace
+
+// static
+bool Document::ParseInParallel(std::string_view input,
+                               const std::vector<Container>& index,
+                               const std::vector<ScanState>& parts,
+                               bool lazy,
+                               const Parallelism& parallelism,
+                               std::vector<Node>& tape,
+                               Progress* progress) {
+  // The root must be the first container.
+  size_t first = 0;
+  while (first < input.size() && IsWhitespace(input[first]))
+    first++;
+  if (index.empty() || index[0].begin != first || input[first] != '[')
+    return false;
+  const std::vector<size_t> begins =
+      ChunkBegins(input, index, parts, parallelism.chunk_size);
+  if (begins.size() < 2)
+    return false;
+  const Index view(index);
+
+  // The chunks are taken in order by the threads, as they become available.
+  struct Chunk {
+    std::vector<Node> tape;
+    std::vector<Node> elements;
+  };
+  std::vector<Chunk> chunks(begins.size());
+  std::atomic<size_t> next_chunk = 0;
+  std::atomic<bool> failed = false;
+  auto work = [&] {
+    while (!failed) {
+      const size_t i = next_chunk++;
+      if (i >= chunks.size())
+        return;
+      Parser parser(input, chunks[i].tape, lazy ? &view : nullptr, progress);
+      const size_t end =
+          i + 1 < begins.size() ? begins[i + 1] : std::string_view::npos;
+      if (!parser.RunChunk(begins[i], end, i == 0, chunks[i].elements))
+        failed = true;
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < std::min(parallelism.threads, chunks.size()); ++i)
+    threads.emplace_back(work);
+  work();
+  for (std::thread& thread : threads)
+    thread.join();
+  if (failed)
+    return false;
+
+  // Stitch the chunks, like the serial parser would have written them: the
+  // nested containers, then the elements of the root.
+  size_t size = 1;
+  for (const Chunk& chunk : chunks)
+    size += chunk.tape.size() + chunk.elements.size();
+  if (size > std::numeric_limits<uint32_t>::max())
+    return false;
+  tape.clear();
+  tape.reserve(size);
+  tape.emplace_back();
+
+  // The children of the chunk's containers are moved by |base|. The unloaded
+  // ones refer to the index instead.
+  auto append = [&tape](const std::vector<Node>& nodes, size_t base) {
+    for (Node node : nodes) {
+      if ((node.type == Type::Object || node.type == Type::Array) &&
+          !(node.flags & kUnloaded)) {
+        node.first_child += static_cast<uint32_t>(base);
+      }
+      tape.push_back(node);
+    }
+  };
+  std::vector<size_t> bases;
+  for (const Chunk& chunk : chunks) {
+    bases.push_back(tape.size());
+    append(chunk.tape, bases.back());
+  }
+  Node& root = tape[0];
+  root.offset = index[0].begin;
+  root.type = Type::Array;
+  root.first_child = static_cast<uint32_t>(tape.size());
+  root.size = static_cast<uint32_t>(size - tape.size());
+  for (size_t i = 0; i < chunks.size(); ++i)
+    append(chunks[i].elements, bases[i]);
+  if (progress) {
+    progress->nodes++;  // The root.
+    progress->chunks = chunks.size();
+  }
+  return true;
+}
+
+// static
+bool Document::Parse(std::string_view input,
+                     Document& out,
+                     std::string& error) {
+  return Parse(input, out, error, Parallelism());
+}
+
+// static
+bool Document::Parse(std::string_view input,
+                     Document& out,
+                     std::string& error,
+                     const Parallelism& parallelism) {
+  ParseError parse_error;
+  if (Parse(input, out, parse_error, parallelism))
+    return true;
+  error = FormatError(input, parse_error.position, parse_error.message);
+  return false;
+}
+
+// static
+bool Document::Parse(std::string_view input,
+                     Document& out,
+                     ParseError& error,
+                     const Parallelism& parallelism) {
+  out.input_ = input;
+  out.containers_.clear();
+  out.snapshot_index_.reset();
+  out.snapshot_owner_.reset();
+
+  // The structural index tells where the chunks can begin. It is only built
+  // when there is something to parallelize.
+  const Parallelism resolved = Resolve(parallelism);
+  if (resolved.threads > 1 && input.size() >= 2 * resolved.chunk_size) {
+    std::vector<Container> index;
+    std::vector<ScanState> parts;
+    std::string index_error;
+    if (IndexContainers(input, index, parts, index_error) &&
+        ParseInParallel(input, index, parts, /*lazy=*/false, resolved,
+                        out.tape_)) {
+      return true;
+    }
+  }
+
+  Parser parser(input, out.tape_);
+  if (parser.Run())
+    return true;
+
+  error = {parser.position(), parser.error()};
+  out.tape_.clear();
+  return false;
+}
+
+// static
+bool Document::ParseOwned(std::string input,
+                          Document& out,
+                          std::string& error) {
+  out.storage_ = std::make_unique<std::string>(std::move(input));
+  return Parse(*out.storage_, out, error);
+}
+
+// static
+bool Document::ParseOwned(std::string input,
+                          Document& out,
+                          ParseError& error) {
+  out.storage_ = std::make_unique<std::string>(std::move(input));
+  return Parse(*out.storage_, out, error, Parallelism());
+}
+
+// static
+bool Document::ParseLazily(std::string_view input,
+                           Document& out,
+                           std::string& error) {
+  return ParseLazily(input, out, error, Parallelism());
+}
+
+// static
+bool Document::ParseLazily(std::string_view input,
+                           Document& out,
+                           std::string& error,
+                           const Parallelism& parallelism,
+                           Progress* progress) {
+  out.input_ = input;
+  out.containers_.clear();
+  out.snapshot_index_.reset();
+  out.snapshot_owner_.reset();
+  std::vector<ScanState> parts;
+  if (!IndexContainers(input, out.containers_, parts, error, progress))
+    return false;
+
+  const Parallelism resolved = Resolve(parallelism);
+  if (resolved.threads > 1 && input.size() >= 2 * resolved.chunk_size &&
+      ParseInParallel(input, out.containers_, parts, /*lazy=*/true, resolved,
+                      out.tape_, progress)) {
+    return true;
+  }
+
+  // The chunks parsed before a failure were reported. Start again.
+  if (progress) {
+    progress->parsed = 0;
+    progress->nodes = 0;
+  }
+  const Index index(out.containers_);
+  Parser parser(input, out.tape_, &index, progress);
+  if (parser.Run())
+    return true;
+
+  error = FormatError(input, parser.position(), parser.error());
+  out.tape_.clear();
+  return false;
+}
+
+bool Document::Load(const Value& value, std::string& error) const {
+  if (value.loaded())
+    return true;
+
+  // The parser appends to the tape, so work on a copy of the node.
+  Node node = tape_[value.index()];
+  const Index containers = index();
+  Parser parser(input_, tape_, &containers);
+  if (!parser.Load(node)) {
+    error = FormatError(input_, parser.position(), parser.error());
+    return false;
+  }
+  tape_[value.index()] = node;
+  return true;
+}
+
+// Match the brackets found by the structural scanner. This only validates
+// the structure of the document. Everything else is validated when the
+// containers are loaded.
+// static
+bool Document::IndexContainers(std::string_view input,
+                               std::vector<Container>& containers,
+                               std::vector<ScanState>& parts,
+                               std::string& error,
+                               Progress* progress) {
+  StructuralScanner scanner;
+  std::vector<uint64_t> brackets;
+  struct Open {
+    uint32_t container;
+    char bracket;
+  };
+  std::vector<Open> stack;
+  for (size_t begin = 0; begin < input.size(); begin += kIndexPartSize) {
+    if (progress) {
+      if (progress->cancel) {
+        error = "cancelled";
+        return false;
+      }
+      progress->indexed = begin;
+    }
+    brackets.clear();
+    parts.push_back(scanner.state());
+    scanner.Scan(input.substr(begin, kIndexPartSize), brackets);
+    if (containers.size() + brackets.size() >=
+        std::numeric_limits<uint32_t>::max()) {
+      error = FormatError(input, begin, "the document has too many nodes");
+      return false;
+    }
+
+    for (const uint64_t position : brackets) {
+      const char c = input[position];
+      if (c == '{' || c == '[') {
+        stack.push_back({static_cast<uint32_t>(containers.size()), c});
+        containers.push_back({position, 0, 0});
+        continue;
+      }
+
+      const char open = c == '}' ? '{' : '[';
+      if (stack.empty() || stack.back().bracket != open) {
+        error = FormatError(input, position, "unexpected closing bracket");
+        return false;
+      }
+      Container& container = containers[stack.back().container];
+      container.end = position;
+      container.next = static_cast<uint32_t>(containers.size());
+      stack.pop_back();
+    }
+  }
+
+  if (scanner.in_string()) {
+    error = FormatError(input, input.size(), "unterminated string");
+    return false;
+  }
+  if (!stack.empty()) {
+    error = FormatError(input, input.size(), "unexpected end of input");
+    return false;
+  }
+  if (progress)
+    progress->indexed = input.size();
+  return true;
+}
+
+// static
+std::string Document::FormatError(std::string_view input,
+                                  size_t position,
+                                  const std::string& message) {
+  size_t line = 1;
+  size_t column = 1;
+  for (size_t i = 0; i < position && i < input.size(); ++i) {
+    column++;
+    if (input[i] == '\n') {
+      line++;
+      column = 1;
+    }
+  }
+  return "parse error at line " + std::to_string(line) + ", column " +
+         std::to_string(column) + ": " + message;
+}
+
+std::vector<uint64_t> Document::SplitPoints(uint64_t spacing) const {
+  // The containers are sorted by their opening bracket.
+  std::vector<uint64_t> out;
+  const Index containers = index();
+  auto it = containers.begin();
+  while (true) {
+    const uint64_t target = out.empty() ? spacing : out.back() + spacing;
+    it = std::lower_bound(it, containers.end(), target,
+                          [](const Container& container, uint64_t position) {
+                            return container.begin < position;
+                          });
+    if (it == containers.end())
+      return out;
+    out.push_back(it->begin);
+  }
+}
+
+Document::Snapshot Document::snapshot() const {
+  const Index containers = index();
+  return {
+      std::string_view(reinterpret_cast<const char*>(tape_.data()),
+                       tape_.size() * sizeof(Node)),
+      std::string_view(reinterpret_cast<const char*>(containers.begin()),
+                       containers.size() * sizeof(Container)),
+  };
+}
+
+// The nodes are checked, since they are used without bounds checks. The
+// parser checks the structural index when it loads a container, so it isn't
+// read here: only the pages of the containers being loaded are touched.
+// static
+bool Document::FromSnapshot(std::string_view input,
+                            const Snapshot& snapshot,
+                            std::shared_ptr<const void> owner,
+                            Document& out) {
+  const auto aligned = [](std::string_view array, size_t record) {
+    return reinterpret_cast<uintptr_t>(array.data()) % kSnapshotAlignment ==
+               0 &&
+           array.size() % record == 0;
+  };
+  if (!aligned(snapshot.tape, sizeof(Node)) ||
+      !aligned(snapshot.containers, sizeof(Container)) ||
+      snapshot.tape.empty()) {
+    return false;
+  }
+  const auto* nodes = reinterpret_cast<const Node*>(snapshot.tape.data());
+  const auto* containers =
+      reinterpret_cast<const Container*>(snapshot.containers.data());
+  const size_t node_count = snapshot.tape.size() / sizeof(Node);
+  const size_t container_count = snapshot.containers.size() / sizeof(Container);
+
+  for (size_t i = 0; i < node_count; ++i) {
+    const Node& node = nodes[i];
+    if (node.offset < node.key_offset || node.offset >= input.size() ||
+        node.type > Type::Array) {
+      return false;
+    }
+    if (node.type != Type::Object && node.type != Type::Array) {
+      if (node.size > input.size() - node.offset)
+        return false;
+    } else if (node.flags & kUnloaded) {
+      if (node.first_child >= container_count ||
+          containers[node.first_child].begin != node.offset) {
+        return false;
+      }
+    } else if (node.first_child > node_count ||
+               node.size > node_count - node.first_child) {
+      return false;
+    }
+  }
+
+  out.input_ = input;
+  out.storage_.reset();
+  out.tape_.assign(nodes, nodes + node_count);
+  out.containers_.clear();
+  out.snapshot_owner_ = std::move(owner);
+  out.snapshot_index_ = Index(containers, container_count);
+  return true;
+}
+
+Document::Index Document::index() const {
+  return snapshot_index_ ? *snapshot_index_ : Index(containers_);
+}
+
+Document::Value Document::root() const {
+  return Value(this, 0);
+}
+
+// static
+std::string Document::Unescape(std::string_view raw) {
+  std::string out;
+  out.reserve(raw.size());
+  for (size_t i = 0; i < raw.size(); ++i) {
+    if (raw[i] != '\\') {
+      out += raw[i];
+      continue;
+    }
+
+    switch (raw[++i]) {
+      case 'b':
+        out += '\b';
+        break;
+      case 'f':
+        out += '\f';
+        break;
+      case 'n':
+        out += '\n';
+        break;
+      case 'r':
+        out += '\r';
+        break;
+      case 't':
+        out += '\t';
+        break;
+      case 'u': {
+        uint32_t codepoint = ReadHex4(raw, i + 1);
+        i += 4;
+        if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+          const uint32_t low = ReadHex4(raw, i + 3);
+          codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+          i += 6;
+        }
+        AppendUTF8(codepoint, out);
+        break;
+      }
+      default:  // '"', '\\' and '/'.
+        out += raw[i];
+        break;
+    }
+  }
+  return out;
+}
+
+size_t Document::Value::size() const {
+  if (!is_object() && !is_array())
+    return 0;
+  std::string error;
+  if (!Load(error))
+    return 0;
+  return node().size;
+}
+
+Document::Value Document::Value::child(size_t index) const {
+  std::string error;
+  Load(error);
+  return Value(document_, node().first_child + static_cast<uint32_t>(index));
+}
+
+bool Document::Value::find(std::string_view key, Value& out) const {
+  if (!is_object())
+    return false;
+  for (size_t i = 0; i < size(); ++i) {
+    const Value member = child(i);
+    if ((member.node().flags & kKeyEscaped) ? member.key() == key
+                                             : member.raw_key() == key) {
+      out = member;
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string_view Document::Value::raw_key() const {
+  const Node& n = node();
+  if (n.key_offset == 0)
+    return {};
+  std::string_view input = document_->input_;
+  const size_t begin = n.offset - n.key_offset + 1;
+  size_t end = begin;
+  while (input[end] != '"')
+    end += input[end] == '\\' ? 2 : 1;
+  return input.substr(begin, end - begin);
+}
+
+std::string Document::Value::key() const {
+  std::string_view raw = raw_key();
+  if (node().flags & kKeyEscaped)
+    return Unescape(raw);
+  return std::string(raw);
+}
+
+// Follow the last children down to a scalar, an empty or an unloaded
+// container, and add the closing brackets on the way back up.
+size_t Document::Value::end() const {
+  const Document& document = *document_;
+  const Index containers = document.index();
+  const Node* n = &node();
+  size_t depth = 0;
+  size_t position = 0;
+  while (true) {
+    if (n->type != Type::Object && n->type != Type::Array) {
+      position = n->offset + n->size;
+      break;
+    }
+    if (n->flags & kUnloaded) {
+      position = containers[n->first_child].end + 1;
+      break;
+    }
+    if (n->size == 0) {
+      position = n->offset + 1;
+      depth++;
+      break;
+    }
+    n = &document.tape_[n->first_child + n->size - 1];
+    depth++;
+  }
+  std::string_view input = document.input_;
+  for (; depth; --depth) {
+    while (position < input.size() && IsWhitespace(input[position]))
+      position++;
+    position++;
+  }
+  return std::min(position, input.size());
+}
+
+std::string_view Document::Value::lexeme() const {
+  const Node& n = node();
+  if (n.type == Type::Object || n.type == Type::Array)
+    return {};
+  return document_->input_.substr(n.offset, n.size);
+}
+
+double Document::Value::number() const {
+  if (!is_number())
+    return 0;
+  // The conversion must not depend on the locale: JSON always uses '.'.
+  const std::string_view text = lexeme();
+  double value = 0;
+#if defined(__cpp_lib_to_chars)
+  const std::from_chars_result result =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  const bool out_of_range = result.ec == std::errc::result_out_of_range;
+#else
+  // Some standard libraries lack the floating point std::from_chars.
+  std::istringstream stream{std::string(text)};
+  stream.imbue(std::locale::classic());
+  stream >> value;
+  const bool out_of_range = stream.fail();
+#endif
+  if (!out_of_range)
+    return value;
+  // Like jq: too large is the largest double, too small is zero.
+  const double magnitude =
+      IsLarge(text) ? std::numeric_limits<double>::max() : 0;
+  return text[0] == '-' ? -magnitude : magnitude;
+}
+
+std::string_view Document::Value::raw_string() const {
+  if (!is_string())
+    return {};
+  std::string_view text = lexeme();
+  return text.substr(1, text.size() - 2);
+}
+
+std::string Document::Value::string() const {
+  std::string_view raw = raw_string();
+  if (node().flags & kEscaped)
+    return Unescape(raw);
+  return std::string(raw);
+}
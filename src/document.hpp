@@ -0,0 +1,298 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#ifndef JSON_TUI_DOCUMENT_HPP
+#define JSON_TUI_DOCUMENT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+struct ScanState;
+
+// A read-only JSON document.
+//
+// The nodes are stored in a flat tape of fixed size records. Strings, keys and
+// numbers are not copied: the records refer to the input buffer, which must
+// outlive the document. The children of a container are stored contiguously,
+// so they can be accessed by index.
+//
+// A document can also be parsed lazily. A first pass only records where each
+// container begins and ends. The children of a container are parsed and added
+// to the tape the first time they are accessed.
+class Document {
+ public:
+  enum class Type : uint8_t {
+    Null,
+    False,
+    True,
+    Number,
+    String,
+    Object,
+    Array,
+  };
+
+  class Value;
+
+  // The elements of a large top-level array are split into chunks, parsed on
+  // several threads, and stitched in order. The document and the errors are
+  // the same as with a single thread.
+  struct Parallelism {
+    // The number of threads. 0 uses every core, and 1 parses serially.
+    size_t threads = 0;
+    // The approximate size of a chunk. Smaller inputs are parsed serially.
+    size_t chunk_size = 4 << 20;
+  };
+
+  // Lets another thread follow a parse, and cancel it.
+  struct Progress {
+    // The bytes indexed by the first pass of ParseLazily().
+    std::atomic<uint64_t> indexed = 0;
+    // The bytes parsed. The containers skipped by ParseLazily() count.
+    std::atomic<uint64_t> parsed = 0;
+    // The nodes added to the tape.
+    std::atomic<uint64_t> nodes = 0;
+    // The chunks of the root array parsed in parallel. 0 for a serial parse.
+    std::atomic<uint64_t> chunks = 0;
+    // Set to stop the parse. It then fails.
+    std::atomic<bool> cancel = false;
+  };
+
+  // Parse |input|. It must outlive the document. On failure, return false and
+  // fill |error| with a message locating the error.
+  static bool Parse(std::string_view input, Document& out, std::string& error);
+  static bool Parse(std::string_view input,
+                    Document& out,
+                    std::string& error,
+                    const Parallelism& parallelism);
+
+  // Same as above, but the document keeps the input alive.
+  static bool ParseOwned(std::string input,
+                         Document& out,
+                         std::string& error);
+
+  // Where a parse failed, and why.
+  struct ParseError {
+    size_t position = 0;  // In the input.
+    std::string message;  // Without the position.
+  };
+
+  // Same as above, but the error is not formatted. For callers parsing a part
+  // of a larger input, to locate the error in it.
+  static bool ParseOwned(std::string input, Document& out, ParseError& error);
+
+  // Index the structure of |input|, and parse only the root's children. The
+  // rest is validated and parsed on demand, by Load().
+  static bool ParseLazily(std::string_view input,
+                          Document& out,
+                          std::string& error);
+  static bool ParseLazily(std::string_view input,
+                          Document& out,
+                          std::string& error,
+                          const Parallelism& parallelism,
+                          Progress* progress = nullptr);
+
+  // Parse the children of |value|, if this wasn't done already. This is not
+  // thread-safe.
+  bool Load(const Value& value, std::string& error) const;
+
+  Value root() const;
+  std::string_view input() const { return input_; }
+
+  // The number of nodes in the tape.
+  size_t size() const { return tape_.size(); }
+
+  // Sorted positions outside of strings, at least |spacing| bytes apart, where
+  // the input can be split. Only lazily parsed documents have some.
+  std::vector<uint64_t> SplitPoints(uint64_t spacing) const;
+
+  // Decode the escape sequences of a string, given without its quotes.
+  static std::string Unescape(std::string_view raw);
+
+  // The state of a lazily parsed document: the nodes parsed so far and the
+  // structural index, as arrays of fixed size records. A snapshot can be
+  // written to a file, and mapped back later by FromSnapshot().
+  struct Snapshot {
+    std::string_view tape;
+    std::string_view containers;
+  };
+  // Incremented when the layout of the records changes.
+  static constexpr uint32_t kSnapshotVersion = 1;
+  // The arrays of a snapshot must be aligned on this many bytes.
+  static constexpr size_t kSnapshotAlignment = 8;
+
+  // Valid until the document is modified, for instance by Load().
+  Snapshot snapshot() const;
+
+  // Reopen the document of |input| from a snapshot of it, without parsing the
+  // input again. The tape is copied, but the structural index is used in
+  // place: it must outlive the document, unless |owner| keeps it alive.
+  // Return false when the snapshot doesn't match |input|.
+  static bool FromSnapshot(std::string_view input,
+                           const Snapshot& snapshot,
+                           std::shared_ptr<const void> owner,
+                           Document& out);
+
+ private:
+  class Parser;
+
+  enum Flags : uint8_t {
+    kEscaped = 1 << 0,     // The string contains escape sequences.
+    kKeyEscaped = 1 << 1,  // The key contains escape sequences.
+    kUnloaded = 1 << 2,    // The container's children are not parsed yet.
+  };
+
+  struct Node {
+    // The position of the value in the input.
+    uint64_t offset = 0;
+    // The distance from the key's opening quote to |offset|. Zero when the
+    // node is not an object member.
+    uint32_t key_offset = 0;
+    // Scalars: the length of the lexeme. Containers: the number of children.
+    uint32_t size = 0;
+    // Containers: the index of the first child in the tape. For unloaded
+    // containers, the index of the container in |containers_|.
+    uint32_t first_child = 0;
+    Type type = Type::Null;
+    uint8_t flags = 0;
+    // The padding is explicit, so that a snapshot written to a file has no
+    // uninitialized bytes.
+    uint16_t unused = 0;
+  };
+  static_assert(sizeof(Node) == 24, "Tape nodes should stay compact.");
+  static_assert(std::has_unique_object_representations_v<Node>,
+                "Tape nodes should have no implicit padding.");
+
+  // The structural index. One entry per container, in document order.
+  struct Container {
+    uint64_t begin = 0;   // Position of the opening bracket.
+    uint64_t end = 0;     // Position of the closing bracket.
+    uint32_t next = 0;    // Index of the first container after this one.
+    uint32_t unused = 0;  // Explicit padding. See Node.
+  };
+  static_assert(std::has_unique_object_representations_v<Container>,
+                "Containers should have no implicit padding.");
+
+  // A view of the structural index: |containers_|, or the one of a snapshot.
+  class Index {
+   public:
+    Index(const Container* data, size_t size) : data_(data), size_(size) {}
+    explicit Index(const std::vector<Container>& containers)
+        : Index(containers.data(), containers.size()) {}
+
+    const Container* begin() const { return data_; }
+    const Container* end() const { return data_ + size_; }
+    size_t size() const { return size_; }
+    const Container& operator[](size_t index) const { return data_[index]; }
+
+   private:
+    const Container* data_;
+    size_t size_;
+  };
+  Index index() const;
+
+  // Also fill |parts| with the state of the scanner at the beginning of every
+  // part it scanned, to find the commas of the root again from there.
+  static bool IndexContainers(std::string_view input,
+                              std::vector<Container>& containers,
+                              std::vector<ScanState>& parts,
+                              std::string& error,
+                              Progress* progress = nullptr);
+  // Parse the input in chunks, given the structural |index| and the |parts| of
+  // the scan. When |lazy|, the nested containers are skipped. Return false
+  // when the input isn't a large top-level array, or on any error: the serial
+  // parser then reports it.
+  static bool ParseInParallel(std::string_view input,
+                              const std::vector<Container>& index,
+                              const std::vector<ScanState>& parts,
+                              bool lazy,
+                              const Parallelism& parallelism,
+                              std::vector<Node>& tape,
+                              Progress* progress = nullptr);
+  static bool Parse(std::string_view input,
+                    Document& out,
+                    ParseError& error,
+                    const Parallelism& parallelism);
+  static std::string FormatError(std::string_view input,
+                                 size_t position,
+                                 const std::string& message);
+
+  std::string_view input_;
+  std::unique_ptr<std::string> storage_;
+  // Grows as the containers are loaded.
+  mutable std::vector<Node> tape_;
+  std::vector<Container> containers_;
+  // The structural index of a snapshot, used instead of |containers_|.
+  std::optional<Index> snapshot_index_;
+  std::shared_ptr<const void> snapshot_owner_;
+};
+
+// A node of a Document. This is a cheap handle, the document must outlive it.
+class Document::Value {
+ public:
+  Value() = default;
+  Value(const Document* document, uint32_t index)
+      : document_(document), index_(index) {}
+
+  Type type() const { return node().type; }
+  bool is_null() const { return type() == Type::Null; }
+  bool is_boolean() const {
+    return type() == Type::False || type() == Type::True;
+  }
+  bool is_number() const { return type() == Type::Number; }
+  bool is_string() const { return type() == Type::String; }
+  bool is_object() const { return type() == Type::Object; }
+  bool is_array() const { return type() == Type::Array; }
+
+  // The number of children of an object or an array. The children of an
+  // unloaded container are loaded first.
+  size_t size() const;
+  Value child(size_t index) const;
+  // The first member of an object named |key|. The keys with escape sequences
+  // are decoded to be compared.
+  bool find(std::string_view key, Value& out) const;
+
+  // Whether the children of a container have been parsed.
+  bool loaded() const { return !(node().flags & kUnloaded); }
+  bool Load(std::string& error) const { return document_->Load(*this, error); }
+
+  // Object members only. The key is decoded.
+  bool has_key() const { return node().key_offset != 0; }
+  std::string_view raw_key() const;
+  std::string key() const;
+
+  // The text of a scalar, as written in the input.
+  std::string_view lexeme() const;
+
+  bool boolean() const { return type() == Type::True; }
+  // The value of a number, rounded to a double. Displaying the lexeme keeps
+  // every digit.
+  double number() const;
+  std::string_view raw_string() const;  // Without the quotes.
+  std::string string() const;           // Decoded.
+
+  // The position of the value in the input.
+  size_t offset() const { return node().offset; }
+  // The position of the member's key, or of the value.
+  size_t begin() const { return node().offset - node().key_offset; }
+  // The position following the value, after the closing bracket of a
+  // container. The containers aren't loaded.
+  size_t end() const;
+
+  const Document* document() const { return document_; }
+  uint32_t index() const { return index_; }
+
+ private:
+  const Node& node() const { return document_->tape_[index_]; }
+
+  const Document* document_ = nullptr;
+  uint32_t index_ = 0;
+};
+
+#endif  // JSON_TUI_DOCUMENT_HPP
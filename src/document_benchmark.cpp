@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include "document.hpp"
+#include "json_generator.hpp"
+
+namespace {
+
+constexpr Shape kShapes[] = {Shape::Deep, Shape::Wide, Shape::Strings,
+                             Shape::Numbers, Shape::Table};
+
+void Sizes(benchmark::internal::Benchmark* benchmark) {
+  for (int64_t size : {int64_t(1) << 10, int64_t(1) << 20, int64_t(64) << 20,
+                       int64_t(1) << 30}) {
+    benchmark->Arg(size);
+  }
+  benchmark->Unit(benchmark::kMillisecond);
+}
+
+void BM_Parse(benchmark::State& state, Shape shape) {
+  const std::string& input = CachedJSON(shape, state.range(0));
+  for (auto _ : state) {
+    Document document;
+    std::string error;
+    benchmark::DoNotOptimize(Document::Parse(input, document, error));
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * input.size());
+}
+
+void BM_ParseLazily(benchmark::State& state, Shape shape) {
+  const std::string& input = CachedJSON(shape, state.range(0));
+  for (auto _ : state) {
+    Document document;
+    std::string error;
+    benchmark::DoNotOptimize(Document::ParseLazily(input, document, error));
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * input.size());
+}
+
+// The parallel parse of a large array, from 1 to 16 threads.
+void BM_ParseThreads(benchmark::State& state, Shape shape) {
+  const std::string& input = CachedJSON(shape, int64_t(256) << 20);
+  Document::Parallelism parallelism;
+  parallelism.threads = state.range(0);
+  for (auto _ : state) {
+    Document document;
+    std::string error;
+    benchmark::DoNotOptimize(
+        Document::Parse(input, document, error, parallelism));
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * input.size());
+}
+
+void Threads(benchmark::internal::Benchmark* benchmark) {
+  for (int64_t threads : {1, 2, 4, 8, 16})
+    benchmark->Arg(threads);
+  benchmark->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+// Register |function| for every shape.
+void Register(const char* name,
+              void (*function)(benchmark::State&, Shape),
+              void (*sizes)(benchmark::internal::Benchmark*)) {
+  for (Shape shape : kShapes) {
+    const std::string full_name = std::string(name) + "/" + ShapeName(shape);
+    benchmark::RegisterBenchmark(full_name.c_str(), function, shape)
+        ->Apply(sizes);
+  }
+}
+
+const bool registered = [] {
+  Register("BM_Parse", BM_Parse, Sizes);
+  Register("BM_ParseLazily", BM_ParseLazily, Sizes);
+  Register("BM_ParseThreads", BM_ParseThreads, Threads);
+  return true;
+}();
+
+}  // namespace
@@ -0,0 +1,391 @@
+#include <gtest/gtest.h>
+#include <clocale>
+#include <limits>
+#include "document.hpp"
+#include "json_generator.hpp"
+
+namespace {
+
+Document Parse(std::string_view input) {
+  Document document;
+  std::string error;
+  EXPECT_TRUE(Document::Parse(input, document, error)) << error;
+  return document;
+}
+
+std::string ParseError(std::string_view input) {
+  Document document;
+  std::string error;
+  EXPECT_FALSE(Document::Parse(input, document, error));
+  return error;
+}
+
+}  // namespace
+
+TEST(Document, Scalars) {
+  EXPECT_TRUE(Parse("null").root().is_null());
+  EXPECT_TRUE(Parse(" true ").root().boolean());
+  EXPECT_FALSE(Parse("false").root().boolean());
+  EXPECT_EQ(Parse("-12.5e+3").root().lexeme(), "-12.5e+3");
+  EXPECT_EQ(Parse("\"abc\"").root().string(), "abc");
+  EXPECT_EQ(Parse("\"abc\"").root().lexeme(), "\"abc\"");
+}
+
+TEST(Document, Numbers) {
+  EXPECT_EQ(Parse("-12.5e+3").root().number(), -12500);
+  EXPECT_EQ(Parse("0").root().number(), 0);
+  EXPECT_EQ(Parse("\"1\"").root().number(), 0);
+  // The lexeme keeps the digits a double can't hold.
+  const std::string big = "123456789012345678901234567890";
+  EXPECT_EQ(Parse(big).root().lexeme(), big);
+  EXPECT_EQ(Parse(big).root().number(), 1.2345678901234568e29);
+  const std::string precise = "0." + std::string(100, '1');
+  EXPECT_EQ(Parse(precise).root().lexeme(), precise);
+  EXPECT_DOUBLE_EQ(Parse(precise).root().number(), 1.0 / 9);
+  // Out of the range of a double. Like jq, they are clamped.
+  EXPECT_EQ(Parse("1e999").root().number(), std::numeric_limits<double>::max());
+  EXPECT_EQ(Parse("-1e999").root().number(),
+            -std::numeric_limits<double>::max());
+  EXPECT_EQ(Parse("1e-999").root().number(), 0);
+  // The magnitude depends on the digits too, not only on the exponent.
+  const std::string zeros(400, '0');
+  EXPECT_EQ(Parse("0." + zeros + "1").root().number(), 0);
+  EXPECT_EQ(Parse("-0." + zeros + "1").root().number(), 0);
+  EXPECT_EQ(Parse("0." + zeros + "1e800").root().number(),
+            std::numeric_limits<double>::max());
+  EXPECT_EQ(Parse("1" + zeros).root().number(),
+            std::numeric_limits<double>::max());
+  EXPECT_EQ(Parse("-1" + zeros + "e-1").root().number(),
+            -std::numeric_limits<double>::max());
+  EXPECT_EQ(Parse("1" + zeros + "e-800").root().number(), 0);
+  EXPECT_EQ(Parse("1e-99999999999999999999").root().number(), 0);
+}
+
+// JSON numbers always use '.', whatever the decimal separator of the locale.
+TEST(Document, NumbersInLocale) {
+  const std::string previous = setlocale(LC_ALL, nullptr);
+  bool found = false;
+  for (const char* name : {"de_DE.UTF-8", "fr_FR.UTF-8", "de_DE", "fr_FR",
+                           "German_Germany.1252", "French_France.1252"}) {
+    if (setlocale(LC_ALL, name)) {
+      found = true;
+      break;
+    }
+  }
+  if (!found)
+    GTEST_SKIP() << "No locale using ',' as the decimal separator";
+  EXPECT_EQ(Parse("1.5").root().number(), 1.5);
+  EXPECT_EQ(Parse("-2.25e1").root().number(), -22.5);
+  setlocale(LC_ALL, previous.c_str());
+}
+
+TEST(Document, Containers) {
+  auto document = Parse(R"({"a": [1, 2, {"b": null}], "c": {}, "d": []})");
+  auto root = document.root();
+  ASSERT_TRUE(root.is_object());
+  ASSERT_EQ(root.size(), 3u);
+
+  auto a = root.child(0);
+  EXPECT_EQ(a.key(), "a");
+  ASSERT_TRUE(a.is_array());
+  ASSERT_EQ(a.size(), 3u);
+  EXPECT_FALSE(a.child(0).has_key());
+  EXPECT_EQ(a.child(0).lexeme(), "1");
+  EXPECT_EQ(a.child(1).lexeme(), "2");
+  EXPECT_EQ(a.child(2).child(0).key(), "b");
+  EXPECT_TRUE(a.child(2).child(0).is_null());
+
+  EXPECT_EQ(root.child(1).key(), "c");
+  EXPECT_TRUE(root.child(1).is_object());
+  EXPECT_EQ(root.child(1).size(), 0u);
+  EXPECT_EQ(root.child(2).key(), "d");
+  EXPECT_TRUE(root.child(2).is_array());
+  EXPECT_EQ(root.child(2).size(), 0u);
+
+  // Root, 3 members, 3 elements, 1 nested member.
+  EXPECT_EQ(document.size(), 8u);
+}
+
+TEST(Document, Escapes) {
+  auto document = Parse(R"({"k\"ey": "a\n\u00e9\ud83d\ude00\/"})");
+  auto member = document.root().child(0);
+  EXPECT_EQ(member.raw_key(), "k\\\"ey");
+  EXPECT_EQ(member.key(), "k\"ey");
+  EXPECT_EQ(member.string(), "a\n\xC3\xA9\xF0\x9F\x98\x80/");
+}
+
+TEST(Document, Owned) {
+  Document document;
+  std::string error;
+  EXPECT_TRUE(Document::ParseOwned("[\"owned\"]", document, error));
+  Document moved = std::move(document);
+  EXPECT_EQ(moved.root().child(0).string(), "owned");
+}
+
+TEST(Document, Errors) {
+  EXPECT_EQ(ParseError(""),
+            "parse error at line 1, column 1: unexpected end of input; "
+            "expected a value");
+  EXPECT_EQ(ParseError("[1,\n 2,]"),
+            "parse error at line 2, column 4: syntax error while parsing "
+            "value");
+  EXPECT_EQ(ParseError("{\"a\" 1}"), "parse error at line 1, column 6: expected ':'");
+  ParseError("[1 2]");
+  ParseError("{1: 2}");
+  ParseError("[01]");
+  ParseError("[1.]");
+  ParseError("[tru]");
+  ParseError("\"abc");
+  ParseError("\"\\x\"");
+  ParseError("\"\\ud800\"");
+  ParseError("\"\xff\"");
+  ParseError("\"a\nb\"");
+  ParseError("[1] 2");
+  ParseError("[[1]");
+  ParseError("[1}");
+}
+
+TEST(Document, Lazy) {
+  Document document;
+  std::string error;
+  ASSERT_TRUE(Document::ParseLazily(
+      R"({"a": [1, {"b": "]"}], "c": {"d": [[]]}, "e": 2})", document, error))
+      << error;
+  auto root = document.root();
+  ASSERT_EQ(root.size(), 3u);
+  // Root and its 3 members.
+  EXPECT_EQ(document.size(), 4u);
+
+  auto a = root.child(0);
+  EXPECT_FALSE(a.loaded());
+  ASSERT_TRUE(a.Load(error)) << error;
+  EXPECT_TRUE(a.loaded());
+  ASSERT_EQ(a.size(), 2u);
+  EXPECT_EQ(a.child(0).lexeme(), "1");
+  EXPECT_FALSE(a.child(1).loaded());
+  EXPECT_EQ(a.child(1).child(0).string(), "]");
+
+  // Loaded implicitly.
+  auto d = root.child(1).child(0);
+  EXPECT_EQ(d.key(), "d");
+  ASSERT_EQ(d.size(), 1u);
+  EXPECT_EQ(d.child(0).size(), 0u);
+  EXPECT_EQ(root.child(2).lexeme(), "2");
+}
+
+TEST(Document, LazyErrors) {
+  Document document;
+  std::string error;
+  EXPECT_FALSE(Document::ParseLazily("[[1]", document, error));
+  EXPECT_EQ(error, "parse error at line 1, column 5: unexpected end of input");
+  EXPECT_FALSE(Document::ParseLazily("[1}", document, error));
+  EXPECT_FALSE(Document::ParseLazily("[\"]", document, error));
+  EXPECT_FALSE(Document::ParseLazily("[1 [2]]", document, error));
+
+  // Errors inside nested containers are found when they are loaded.
+  ASSERT_TRUE(Document::ParseLazily("[1, [2, tru]]", document, error));
+  auto nested = document.root().child(1);
+  EXPECT_FALSE(nested.Load(error));
+  EXPECT_EQ(error, "parse error at line 1, column 9: invalid literal");
+  EXPECT_EQ(nested.size(), 0u);
+}
+
+TEST(Document, SplitPoints) {
+  Document document;
+  std::string error;
+  const std::string input = R"([{"a": "[x"}, [1], {"b": [2]}])";
+  ASSERT_TRUE(Document::ParseLazily(input, document, error)) << error;
+  EXPECT_EQ(document.SplitPoints(1), (std::vector<uint64_t>{1, 14, 19, 25}));
+  EXPECT_EQ(document.SplitPoints(10), (std::vector<uint64_t>{14, 25}));
+  EXPECT_TRUE(document.SplitPoints(100).empty());
+
+  auto b = document.root().child(2).child(0);
+  EXPECT_EQ(b.begin(), 20u);
+  EXPECT_EQ(b.offset(), 25u);
+}
+
+TEST(Document, End) {
+  const std::string input = R"({"a": [1, [2, {}] ], "b": "x" , "c": [ ]} )";
+  Document document;
+  std::string error;
+  ASSERT_TRUE(Document::ParseLazily(input, document, error)) << error;
+  const Document::Value root = document.root();
+  EXPECT_EQ(root.end(), input.size() - 1);
+  EXPECT_EQ(input.substr(0, root.child(0).end()).back(), ']');
+  EXPECT_EQ(root.child(0).end(), input.find(", \"b\""));
+  EXPECT_EQ(root.child(1).end(), input.find(" , \"c\""));
+  EXPECT_EQ(root.child(2).end(), input.find("} "));
+
+  // Loaded or not.
+  ASSERT_TRUE(root.child(0).Load(error));
+  EXPECT_EQ(root.child(0).end(), input.find(", \"b\""));
+  EXPECT_EQ(root.child(0).child(1).end(), input.find(" ]"));
+}
+
+namespace {
+
+// The nodes must be the same, at the same place in the tape.
+void ExpectSameTape(const Document& a, const Document& b) {
+  ASSERT_EQ(a.size(), b.size());
+  for (uint32_t i = 0; i < a.size(); ++i) {
+    const Document::Value x(&a, i);
+    const Document::Value y(&b, i);
+    ASSERT_EQ(x.type(), y.type()) << i;
+    ASSERT_EQ(x.offset(), y.offset()) << i;
+    ASSERT_EQ(x.begin(), y.begin()) << i;
+    ASSERT_EQ(x.loaded(), y.loaded()) << i;
+    if ((x.is_object() || x.is_array()) && x.loaded()) {
+      ASSERT_EQ(x.size(), y.size()) << i;
+      if (x.size()) {
+        ASSERT_EQ(x.child(0).index(), y.child(0).index()) << i;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(Document, Parallel) {
+  const Document::Parallelism serial = {1, 0};
+  for (Shape shape : {Shape::Deep, Shape::Wide, Shape::Strings, Shape::Numbers,
+                      Shape::Table}) {
+    const std::string input = GenerateJSON(shape, 1 << 16);
+    for (size_t chunk_size : {1, 100, 5000}) {
+      SCOPED_TRACE(std::string(ShapeName(shape)) + " " +
+                   std::to_string(chunk_size));
+      const Document::Parallelism parallel = {4, chunk_size};
+      Document expected, document;
+      std::string error;
+      ASSERT_TRUE(Document::Parse(input, expected, error, serial)) << error;
+      ASSERT_TRUE(Document::Parse(input, document, error, parallel)) << error;
+      ExpectSameTape(expected, document);
+
+      ASSERT_TRUE(Document::ParseLazily(input, expected, error, serial));
+      ASSERT_TRUE(Document::ParseLazily(input, document, error, parallel));
+      ExpectSameTape(expected, document);
+    }
+  }
+}
+
+TEST(Document, Progress) {
+  const std::string input = GenerateJSON(Shape::Table, 1 << 22);
+  for (const Document::Parallelism parallelism :
+       {Document::Parallelism{1, 0}, Document::Parallelism{4, 1 << 16}}) {
+    Document::Progress progress;
+    Document document;
+    std::string error;
+    ASSERT_TRUE(Document::ParseLazily(input, document, error, parallelism,
+                                      &progress))
+        << error;
+    EXPECT_EQ(progress.indexed, input.size());
+    EXPECT_EQ(progress.parsed, document.root().end());
+    EXPECT_EQ(progress.nodes, document.size());
+  }
+
+  Document::Progress progress;
+  progress.cancel = true;
+  Document document;
+  std::string error;
+  EXPECT_FALSE(Document::ParseLazily(input, document, error,
+                                     Document::Parallelism(), &progress));
+  EXPECT_EQ(error, "cancelled");
+}
+
+TEST(Document, ParallelErrors) {
+  const Document::Parallelism serial = {1, 0};
+  const Document::Parallelism parallel = {4, 2};
+  for (std::string_view input : {
+           "[1, 2, 3, 4, 5, 6, tru, 8, 9]",
+           "[1, 2, 3, 4, 5, 6, 7, 8, 9,]",
+           "[1, 2, 3, 4, 5, 6, 7, 8, 9] 10",
+           "1 [1, 2, 3, 4, 5, 6, 7, 8, 9]",
+           "[1, 2, 3, 4, 5, 6 7, 8, 9]",
+           "[1, \"a,b\", 3, \"c, d\", {\"e\": [1, 2, 3]}, [[6], 7], 8, 9]",
+           "[1, 2, 3, {\"a\": 4,, \"b\": 5}, 6, 7, 8]",
+       }) {
+    SCOPED_TRACE(input);
+    Document expected, document;
+    std::string expected_error, error;
+    const bool valid = Document::Parse(input, expected, expected_error, serial);
+    EXPECT_EQ(Document::Parse(input, document, error, parallel), valid);
+    EXPECT_EQ(error, expected_error);
+    if (valid)
+      ExpectSameTape(expected, document);
+
+    expected_error.clear();
+    error.clear();
+    const bool lazy_valid =
+        Document::ParseLazily(input, expected, expected_error, serial);
+    EXPECT_EQ(Document::ParseLazily(input, document, error, parallel),
+              lazy_valid);
+    EXPECT_EQ(error, expected_error);
+    if (lazy_valid)
+      ExpectSameTape(expected, document);
+  }
+}
+
+TEST(Document, ParallelCommasInStrings) {
+  // Log lines, with commas and escaped quotes, across many parts of the index.
+  std::string input = "[";
+  for (int i = 0; i < 20000; ++i) {
+    if (i)
+      input += ", ";
+    if (i % 7 == 0)
+      input += R"({"line": "a, b", "n": [1, 2]})";
+    else
+      input += "\"GET /api/v1/items/" + std::to_string(i) +
+               R"(, status=200, agent=\"x, \\\", y\"")";
+  }
+  input += "]";
+
+  const Document::Parallelism serial = {1, 0};
+  const Document::Parallelism parallel = {4, 1 << 14};
+  Document expected, document;
+  std::string error;
+  ASSERT_TRUE(Document::Parse(input, expected, error, serial)) << error;
+  ASSERT_TRUE(Document::Parse(input, document, error, parallel)) << error;
+  ExpectSameTape(expected, document);
+
+  Document::Progress progress;
+  ASSERT_TRUE(Document::ParseLazily(input, expected, error, serial));
+  ASSERT_TRUE(
+      Document::ParseLazily(input, document, error, parallel, &progress));
+  ExpectSameTape(expected, document);
+  EXPECT_GT(progress.chunks, input.size() / (1 << 14) / 2);
+}
+
+TEST(Document, Snapshot) {
+  const std::string input = R"({"a": [1, {"b": "]"}], "c": {"d": [[]]}})";
+  Document expected, document;
+  std::string error;
+  ASSERT_TRUE(Document::ParseLazily(input, expected, error)) << error;
+
+  // Copy the snapshot, like a file mapped in memory.
+  const Document::Snapshot snapshot = expected.snapshot();
+  auto copy = std::make_shared<std::vector<uint64_t>>(
+      (snapshot.tape.size() + snapshot.containers.size()) / sizeof(uint64_t));
+  char* data = reinterpret_cast<char*>(copy->data());
+  std::copy(snapshot.tape.begin(), snapshot.tape.end(), data);
+  std::copy(snapshot.containers.begin(), snapshot.containers.end(),
+            data + snapshot.tape.size());
+  const Document::Snapshot copied = {
+      {data, snapshot.tape.size()},
+      {data + snapshot.tape.size(), snapshot.containers.size()},
+  };
+  ASSERT_TRUE(Document::FromSnapshot(input, copied, copy, document));
+  ExpectSameTape(expected, document);
+
+  // The containers are loaded from the index of the snapshot.
+  ASSERT_TRUE(expected.root().child(0).Load(error)) << error;
+  ASSERT_TRUE(document.root().child(0).Load(error)) << error;
+  ASSERT_TRUE(expected.root().child(1).child(0).Load(error)) << error;
+  ASSERT_TRUE(document.root().child(1).child(0).Load(error)) << error;
+  ExpectSameTape(expected, document);
+  EXPECT_EQ(document.root().child(0).child(1).child(0).string(), "]");
+
+  // A snapshot of another input is rejected.
+  EXPECT_FALSE(
+      Document::FromSnapshot(input.substr(0, 10), copied, copy, document));
+  EXPECT_FALSE(Document::FromSnapshot(input, {copied.tape.substr(1), {}},
+                                      copy, document));
+}
@@ -1,18 +1,53 @@
 #include "expander.hpp"
-#include <algorithm>
+
+namespace {
+
+void Count(std::vector<int>& counts, int level, int delta) {
+  if (level >= static_cast<int>(counts.size()))
+    counts.resize(level + 1, 0);
+  counts[level] += delta;
+  while (!counts.empty() && counts.back() == 0)
+    counts.pop_back();
+}
+
+// The levels are bounded by the depth of the tree, so this is fast.
+int LowestLevel(const std::vector<int>& counts) {
+  int level = 0;
+  while (level < static_cast<int>(counts.size()) && counts[level] == 0)
+    level++;
+  return level;
+}
+
+int HighestLevel(const std::vector<int>& counts) {
+  return counts.empty() ? 0 : static_cast<int>(counts.size()) - 1;
+}
+
+}  // namespace
+
+size_t ExpanderImpl::update_count_ = 0;
 
 ExpanderImpl::~ExpanderImpl() {
   // Remove this from parent:
   if (parent_) {
-    parent_->children_.erase(
-        std::remove(parent_->children_.begin(), parent_->children_.end(), this),
-        parent_->children_.end());
+    if (previous_sibling_)
+      previous_sibling_->next_sibling_ = next_sibling_;
+    else
+      parent_->first_child_ = next_sibling_;
+    if (next_sibling_)
+      next_sibling_->previous_sibling_ = previous_sibling_;
+    Count(parent_->children_min_levels_, min_level_, -1);
+    Count(parent_->children_max_levels_, max_level_, -1);
+    parent_->Update();
     parent_ = nullptr;
   }
 
   // Remove this from children:
-  for (auto& child : children_) {
+  for (ExpanderImpl* child = first_child_; child;) {
+    ExpanderImpl* next = child->next_sibling_;
     child->parent_ = nullptr;
+    child->previous_sibling_ = nullptr;
+    child->next_sibling_ = nullptr;
+    child = next;
   }
 }
 
@@ -24,63 +59,93 @@ Expander ExpanderImpl::Root() {
 Expander ExpanderImpl::Child() {
   auto expander = Root();
   expander->parent_ = this;
-  children_.push_back(expander.get());
+  expander->next_sibling_ = first_child_;
+  if (first_child_)
+    first_child_->previous_sibling_ = expander.get();
+  first_child_ = expander.get();
+  Count(children_min_levels_, 0, +1);
+  Count(children_max_levels_, 0, +1);
+  Update();
   return expander;
 }
 
 bool ExpanderImpl::Expand() {
   int min_level = MinLevel();
   Expand(min_level + 1);
+  UpdateAncestors();
   return MinLevel() != min_level;
 }
 
 bool ExpanderImpl::Collapse() {
   int max_level = MaxLevel();
   Collapse(max_level - 1);
+  UpdateAncestors();
   return MaxLevel() != max_level;
 }
 
-int ExpanderImpl::MinLevel() const {
-  if (!expanded) {
-    return 0;
-  }
-  if (children_.size() == 0) {
-    return 1;
+void ExpanderImpl::SetExpanded(bool value) {
+  expanded = value;
+  Update();
+}
+
+void ExpanderImpl::Update() {
+  if (UpdateLevels())
+    UpdateAncestors();
+}
+
+bool ExpanderImpl::UpdateLevels() {
+  update_count_++;
+  int min_level = 0;
+  int max_level = 0;
+  if (expanded) {
+    min_level = first_child_ ? 1 + LowestLevel(children_min_levels_) : 1;
+    max_level = 1 + HighestLevel(children_max_levels_);
   }
-  int min_level = 999999;
-  for (auto& child : children_) {
-    min_level = std::min(min_level, 1 + child->MinLevel());
+  if (min_level == min_level_ && max_level == max_level_)
+    return false;
+
+  if (parent_) {
+    Count(parent_->children_min_levels_, min_level_, -1);
+    Count(parent_->children_min_levels_, min_level, +1);
+    Count(parent_->children_max_levels_, max_level_, -1);
+    Count(parent_->children_max_levels_, max_level, +1);
   }
-  return min_level;
+  min_level_ = min_level;
+  max_level_ = max_level;
+  return true;
 }
 
-int ExpanderImpl::MaxLevel() const {
-  if (!expanded) {
-    return 0;
-  }
-  int max_level = 1;
-  for (auto& child : children_) {
-    max_level = std::max(max_level, 1 + child->MaxLevel());
+void ExpanderImpl::UpdateAncestors() {
+  for (ExpanderImpl* node = parent_; node && node->UpdateLevels();
+       node = node->parent_) {
   }
-  return max_level;
 }
 
+// Expand every node up to a depth of |minLevel|. The subtrees already
+// expanded this deep are skipped.
 void ExpanderImpl::Expand(int minLevel) {
-  if (minLevel <= 0)
+  if (minLevel <= 0 || min_level_ >= minLevel)
     return;
   expanded = true;
   minLevel--;
-  for (auto& child : children_) {
+  for (ExpanderImpl* child = first_child_; child; child = child->next_sibling_)
     child->Expand(minLevel);
-  }
+  UpdateLevels();
 }
 
+// Collapse the nodes deeper than |maxLevel|. The subtrees not expanded this
+// deep are skipped. The descendants of a collapsed node keep their state.
 void ExpanderImpl::Collapse(int maxLevel) {
+  if (max_level_ <= maxLevel)
+    return;
   if (maxLevel <= 0) {
     expanded = false;
+  } else {
+    maxLevel--;
+    for (ExpanderImpl* child = first_child_; child;
+         child = child->next_sibling_) {
+      child->Collapse(maxLevel);
+    }
   }
-  maxLevel--;
-  for (auto& child : children_) {
-    child->Collapse(maxLevel);
-  }
+  UpdateLevels();
 }
@@ -4,12 +4,19 @@
 #ifndef JSON_TUI_EXPANDER_HPP
 #define JSON_TUI_EXPANDER_HPP
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
 class ExpanderImpl;
 using Expander = std::unique_ptr<ExpanderImpl>;
 
+// The expanded/collapsed state of a tree of nodes. '+' expands the shallowest
+// collapsed level, and '-' collapses the deepest expanded one.
+//
+// Every node caches the levels of its subtree, and how many children have
+// each level. A change only updates the ancestors, so the cost doesn't depend
+// on the size of the tree.
 class ExpanderImpl {
  public:
   ~ExpanderImpl();
@@ -19,15 +26,45 @@ class ExpanderImpl {
   bool Expand();
   bool Collapse();
 
-  int MinLevel() const;
-  int MaxLevel() const;
+  // Set |expanded| and update the levels of the ancestors.
+  void SetExpanded(bool value);
+
+  // Update the levels after |expanded| was modified directly, for instance by
+  // a component bound to it.
+  void Update();
+
+  // The length of the shortest/longest chain of expanded nodes starting here.
+  int MinLevel() const { return min_level_; }
+  int MaxLevel() const { return max_level_; }
+
+  // The number of nodes whose levels were recomputed so far, by every
+  // expander. The tests use it to check the cost of a change.
+  static size_t update_count() { return update_count_; }
 
   bool expanded = false;
+
  private:
   void Expand(int minLevel);
   void Collapse(int maxLevel);
 
+  // Recompute the levels of this node from its children's. Return whether they
+  // changed.
+  bool UpdateLevels();
+  void UpdateAncestors();
+
   ExpanderImpl* parent_ = nullptr;
-  std::vector<ExpanderImpl*> children_;
+
+  // The children form a doubly linked list, so that they detach in O(1).
+  ExpanderImpl* first_child_ = nullptr;
+  ExpanderImpl* previous_sibling_ = nullptr;
+  ExpanderImpl* next_sibling_ = nullptr;
+
+  // The number of children, indexed by their MinLevel()/MaxLevel().
+  std::vector<int> children_min_levels_;
+  std::vector<int> children_max_levels_;
+  int min_level_ = 0;
+  int max_level_ = 0;
+
+  static size_t update_count_;
 };
 #endif  // JSON_TUI_EXPANDER_HPP
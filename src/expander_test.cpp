@@ -1,14 +1,15 @@
 #include <gtest/gtest.h>
+#include <vector>
 #include "expander.hpp"
 
 TEST(Expander, Basic) {
-  auto a = ExpanderImpl::New();
-  auto a0 = a->Expander();
-  auto a1 = a->Expander();
-  auto a00 = a0->Expander();
-  auto a01 = a0->Expander();
-  auto a10 = a1->Expander();
-  auto a11 = a1->Expander();
+  auto a = ExpanderImpl::Root();
+  auto a0 = a->Child();
+  auto a1 = a->Child();
+  auto a00 = a0->Child();
+  auto a01 = a0->Child();
+  auto a10 = a1->Child();
+  auto a11 = a1->Child();
 
   EXPECT_EQ(a->MinLevel(), 0);
   EXPECT_EQ(a->MaxLevel(), 0);
@@ -16,7 +17,7 @@ TEST(Expander, Basic) {
   EXPECT_EQ(a00->MinLevel(), 0);
   EXPECT_EQ(a00->MaxLevel(), 0);
 
-  a->expanded = true;
+  a->SetExpanded(true);
 
   EXPECT_EQ(a->MinLevel(), 1);
   EXPECT_EQ(a->MaxLevel(), 1);
@@ -24,45 +25,45 @@ TEST(Expander, Basic) {
   EXPECT_EQ(a00->MinLevel(), 0);
   EXPECT_EQ(a00->MaxLevel(), 0);
 
-  a0->expanded = true;
+  a0->SetExpanded(true);
 
   EXPECT_EQ(a->MinLevel(), 1);
   EXPECT_EQ(a->MaxLevel(), 2);
 
-  a1->expanded = true;
+  a1->SetExpanded(true);
 
   EXPECT_EQ(a->MinLevel(), 2);
   EXPECT_EQ(a->MaxLevel(), 2);
 
-  a00->expanded = true;
+  a00->SetExpanded(true);
 
   EXPECT_EQ(a->MinLevel(), 2);
   EXPECT_EQ(a->MaxLevel(), 3);
 
-  a01->expanded = true;
+  a01->SetExpanded(true);
 
   EXPECT_EQ(a->MinLevel(), 2);
   EXPECT_EQ(a->MaxLevel(), 3);
 
-  a10->expanded = true;
+  a10->SetExpanded(true);
 
   EXPECT_EQ(a->MinLevel(), 2);
   EXPECT_EQ(a->MaxLevel(), 3);
 
-  a11->expanded = true;
+  a11->SetExpanded(true);
 
   EXPECT_EQ(a->MinLevel(), 3);
   EXPECT_EQ(a->MaxLevel(), 3);
 }
 
 TEST(Expander, Expand) {
-  auto a = ExpanderImpl::New();
-  auto a0 = a->Expander();
-  auto a1 = a->Expander();
-  auto a00 = a0->Expander();
-  auto a01 = a0->Expander();
-  auto a10 = a1->Expander();
-  auto a11 = a1->Expander();
+  auto a = ExpanderImpl::Root();
+  auto a0 = a->Child();
+  auto a1 = a->Child();
+  auto a00 = a0->Child();
+  auto a01 = a0->Child();
+  auto a10 = a1->Child();
+  auto a11 = a1->Child();
 
   EXPECT_EQ(a->MinLevel(), 0);
 
@@ -80,7 +81,7 @@ TEST(Expander, Expand) {
 
   // ----
 
-  a1->expanded = false;
+  a1->SetExpanded(false);
   EXPECT_EQ(a->MinLevel(), 1);
 
   a->Expand();
@@ -89,7 +90,7 @@ TEST(Expander, Expand) {
 
   // ----
 
-  a->expanded = false;
+  a->SetExpanded(false);
   EXPECT_EQ(a->MinLevel(), 0);
 
   a->Expand();
@@ -98,13 +99,13 @@ TEST(Expander, Expand) {
 }
 
 TEST(Expander, Collapse) {
-  auto a = ExpanderImpl::New();
-  auto a0 = a->Expander();
-  auto a1 = a->Expander();
-  auto a00 = a0->Expander();
-  auto a01 = a0->Expander();
-  auto a10 = a1->Expander();
-  auto a11 = a1->Expander();
+  auto a = ExpanderImpl::Root();
+  auto a0 = a->Child();
+  auto a1 = a->Child();
+  auto a00 = a0->Child();
+  auto a01 = a0->Child();
+  auto a10 = a1->Child();
+  auto a11 = a1->Child();
 
   EXPECT_EQ(a->MaxLevel(), 0);
 
@@ -125,17 +126,17 @@ TEST(Expander, Collapse) {
 }
 
 TEST(Expander, CollapseBranch) {
-  auto a = ExpanderImpl::New();
-  auto a0 = a->Expander();
-  auto a1 = a->Expander();
-  auto a00 = a0->Expander();
-  auto a01 = a0->Expander();
-  auto a10 = a1->Expander();
-  auto a11 = a1->Expander();
-
-  a->expanded = true;
-  a0->expanded = true;
-  a00->expanded = true;
+  auto a = ExpanderImpl::Root();
+  auto a0 = a->Child();
+  auto a1 = a->Child();
+  auto a00 = a0->Child();
+  auto a01 = a0->Child();
+  auto a10 = a1->Child();
+  auto a11 = a1->Child();
+
+  a->SetExpanded(true);
+  a0->SetExpanded(true);
+  a00->SetExpanded(true);
   EXPECT_EQ(a->MaxLevel(), 3);
 
   a->Collapse();
@@ -156,3 +157,70 @@ TEST(Expander, CollapseBranch) {
   EXPECT_EQ(a00->expanded, false);
   EXPECT_EQ(a->MaxLevel(), 0);
 }
+
+TEST(Expander, Detach) {
+  auto a = ExpanderImpl::Root();
+  auto a0 = a->Child();
+  auto a1 = a->Child();
+  auto a2 = a->Child();
+  a->Expand();
+  a->Expand();
+  a1->SetExpanded(false);
+  EXPECT_EQ(a->MinLevel(), 1);
+
+  a1.reset();
+  EXPECT_EQ(a->MinLevel(), 2);
+  a0.reset();
+  a2.reset();
+  EXPECT_EQ(a->MinLevel(), 1);
+  EXPECT_EQ(a->MaxLevel(), 1);
+
+  // The children outlive their parent.
+  auto b0 = a->Child();
+  a.reset();
+  b0->SetExpanded(true);
+  EXPECT_EQ(b0->MinLevel(), 1);
+}
+
+namespace {
+
+// The number of level updates needed to toggle a leaf of a tree of |size|
+// leaves, |count| times.
+size_t ToggleUpdates(int size, int count) {
+  auto root = ExpanderImpl::Root();
+  std::vector<Expander> nodes;
+  for (int i = 0; i < size / 100; ++i) {
+    nodes.push_back(root->Child());
+    ExpanderImpl* parent = nodes.back().get();
+    for (int j = 0; j < 100; ++j)
+      nodes.push_back(parent->Child());
+  }
+  root->Expand();
+  root->Expand();
+  root->Expand();
+  EXPECT_EQ(root->MinLevel(), 3);
+
+  ExpanderImpl* leaf = nodes.back().get();
+  const size_t start = ExpanderImpl::update_count();
+  for (int i = 0; i < count; ++i) {
+    leaf->SetExpanded(i % 2 == 1);
+    EXPECT_EQ(root->MinLevel(), i % 2 == 1 ? 3 : 2);
+    EXPECT_EQ(root->MaxLevel(), 3);
+  }
+  const size_t updates = ExpanderImpl::update_count() - start;
+
+  root->Collapse();
+  EXPECT_EQ(root->MaxLevel(), 2);
+  root->Expand();
+  EXPECT_EQ(root->MinLevel(), 3);
+  return updates;
+}
+
+}  // namespace
+
+TEST(Expander, Scaling) {
+  // A toggle only updates the leaf and its ancestors, whatever the size of the
+  // tree.
+  EXPECT_LE(ToggleUpdates(2'000, 100), 3u * 100);
+  EXPECT_EQ(ToggleUpdates(200'000, 100), ToggleUpdates(2'000, 100));
+}
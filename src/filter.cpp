@@ -0,0 +1,815 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+
+#include "filter.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <utility>
+#include <vector>
+
+struct Filter::Node {
+  enum class Kind {
+    Identity,
+    Field,     // |name|.
+    Index,     // |begin|.
+    Slice,     // |begin| and |end|, when |has_begin| and |has_end|.
+    Iterate,
+    Pipe,      // |children|, in order.
+    Object,    // |keys|, and their filters in |children|.
+    Select,    // The predicate in |children|.
+    Compare,   // |name| is the operator. |children| are the operands.
+    And,
+    Or,
+    Literal,   // |literal|.
+  };
+  Kind kind = Kind::Identity;
+  std::string name;
+  int64_t begin = 0;
+  int64_t end = 0;
+  bool has_begin = false;
+  bool has_end = false;
+  std::vector<std::string> keys;
+  std::vector<std::unique_ptr<Node>> children;
+  std::shared_ptr<Document> literal;
+};
+
+namespace {
+
+using Node = Filter::Node;
+using Kind = Filter::Node::Kind;
+
+// A value of the input document, or one built by the filter. The values built
+// are parsed into their own document, kept alive by |owner|.
+struct Item {
+  Document::Value value;
+  std::shared_ptr<const Document> owner;
+};
+
+// Return false to stop the evaluation, for instance after the first output.
+using Emit = std::function<bool(const Item&)>;
+
+std::shared_ptr<Document> ParseConstant(std::string json) {
+  auto document = std::make_shared<Document>();
+  std::string error;
+  if (!Document::ParseOwned(std::move(json), *document, error))
+    return nullptr;
+  return document;
+}
+
+Item Constant(std::string json) {
+  std::shared_ptr<Document> document = ParseConstant(std::move(json));
+  return {document->root(), document};
+}
+
+const Item& Null() {
+  static const Item null = Constant("null");
+  return null;
+}
+
+const Item& Boolean(bool value) {
+  static const Item true_item = Constant("true");
+  static const Item false_item = Constant("false");
+  return value ? true_item : false_item;
+}
+
+// The text of |value| in its document.
+std::string_view Text(const Document::Value& value) {
+  return value.document()->input().substr(value.offset(),
+                                          value.end() - value.offset());
+}
+
+// Write |text| as a JSON string.
+void Quote(std::string_view text, std::string& out) {
+  out += '"';
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      static constexpr char kHex[] = "0123456789abcdef";
+      out += "\\u00";
+      out += kHex[c >> 4];
+      out += kHex[c & 0xF];
+    } else {
+      out += c;
+    }
+  }
+  out += '"';
+}
+
+// jq's order: null < false < true < numbers < strings < arrays < objects.
+int Rank(const Document::Value& value) {
+  switch (value.type()) {
+    case Document::Type::Null:
+      return 0;
+    case Document::Type::False:
+      return 1;
+    case Document::Type::True:
+      return 2;
+    case Document::Type::Number:
+      return 3;
+    case Document::Type::String:
+      return 4;
+    case Document::Type::Array:
+      return 5;
+    case Document::Type::Object:
+      return 6;
+  }
+  return 0;
+}
+
+int Sign(int order) {
+  return order < 0 ? -1 : order > 0 ? 1 : 0;
+}
+
+int Compare(const Document::Value& a, const Document::Value& b);
+
+// The members of an object, sorted by key. Like find(), the first of the
+// duplicated keys is kept.
+std::vector<std::pair<std::string, Document::Value>> SortedMembers(
+    const Document::Value& object) {
+  std::vector<std::pair<std::string, Document::Value>> members;
+  members.reserve(object.size());
+  for (size_t i = 0; i < object.size(); ++i)
+    members.emplace_back(object.child(i).key(), object.child(i));
+  std::stable_sort(
+      members.begin(), members.end(),
+      [](const auto& x, const auto& y) { return x.first < y.first; });
+  members.erase(std::unique(members.begin(), members.end(),
+                            [](const auto& x, const auto& y) {
+                              return x.first == y.first;
+                            }),
+                members.end());
+  return members;
+}
+
+// Like jq, the arrays are compared element by element, then by size. The
+// objects are compared by their sorted keys, then by their values in the
+// order of the keys.
+int CompareObjects(const Document::Value& a, const Document::Value& b) {
+  const auto x = SortedMembers(a);
+  const auto y = SortedMembers(b);
+  const size_t size = std::min(x.size(), y.size());
+  for (size_t i = 0; i < size; ++i) {
+    if (const int order = Sign(x[i].first.compare(y[i].first)))
+      return order;
+  }
+  if (x.size() != y.size())
+    return x.size() < y.size() ? -1 : 1;
+  for (size_t i = 0; i < size; ++i) {
+    if (const int order = Compare(x[i].second, y[i].second))
+      return order;
+  }
+  return 0;
+}
+
+int Compare(const Document::Value& a, const Document::Value& b) {
+  const int rank_a = Rank(a);
+  const int rank_b = Rank(b);
+  if (rank_a != rank_b)
+    return rank_a < rank_b ? -1 : 1;
+  if (a.is_number()) {
+    const double x = a.number();
+    const double y = b.number();
+    return x < y ? -1 : x > y ? 1 : 0;
+  }
+  if (a.is_string())
+    return Sign(a.string().compare(b.string()));
+  if (a.is_array()) {
+    const size_t size = std::min(a.size(), b.size());
+    for (size_t i = 0; i < size; ++i) {
+      if (const int order = Compare(a.child(i), b.child(i)))
+        return order;
+    }
+    return a.size() < b.size() ? -1 : a.size() > b.size() ? 1 : 0;
+  }
+  if (a.is_object())
+    return CompareObjects(a, b);
+  return 0;
+}
+
+// Whether the comparison |op| holds, given the order of its operands.
+bool Holds(const std::string& op, int order) {
+  if (op == "==")
+    return order == 0;
+  if (op == "!=")
+    return order != 0;
+  if (op == "<")
+    return order < 0;
+  if (op == "<=")
+    return order <= 0;
+  if (op == ">")
+    return order > 0;
+  return order >= 0;
+}
+
+bool Truthy(const Document::Value& value) {
+  return !value.is_null() && value.type() != Document::Type::False;
+}
+
+// Load the containers of |value|'s subtree not loaded yet. A syntax error in
+// a skipped container is then reported at its position in the input.
+bool LoadAll(const Document::Value& value, std::string& error) {
+  std::vector<Document::Value> stack = {value};
+  while (!stack.empty()) {
+    const Document::Value node = stack.back();
+    stack.pop_back();
+    if (!node.is_object() && !node.is_array())
+      continue;
+    if (!node.Load(error))
+      return false;
+    for (size_t i = 0; i < node.size(); ++i)
+      stack.push_back(node.child(i));
+  }
+  return true;
+}
+
+// Append the text of |value| to |json|, once validated.
+bool Copy(const Document::Value& value, std::string& json, std::string& error) {
+  if (!LoadAll(value, error))
+    return false;
+  json += Text(value);
+  return true;
+}
+
+// The evaluation stops on the first error, after filling |error|.
+bool Evaluate(const Node& node,
+              const Item& input,
+              const Emit& emit,
+              std::string& error);
+
+// The first output of |node|, or null. Check |error| afterward.
+Item First(const Node& node, const Item& input, std::string& error) {
+  Item out = Null();
+  Evaluate(
+      node, input,
+      [&](const Item& item) {
+        out = item;
+        return false;
+      },
+      error);
+  return out;
+}
+
+bool Pipe(const Node& node,
+          size_t stage,
+          const Item& input,
+          const Emit& emit,
+          std::string& error) {
+  if (stage == node.children.size())
+    return emit(input);
+  return Evaluate(
+      *node.children[stage], input,
+      [&](const Item& item) {
+        return Pipe(node, stage + 1, item, emit, error);
+      },
+      error);
+}
+
+bool Evaluate(const Node& node,
+              const Item& input,
+              const Emit& emit,
+              std::string& error) {
+  const Document::Value& value = input.value;
+  switch (node.kind) {
+    case Kind::Identity:
+      return emit(input);
+
+    case Kind::Field: {
+      if (value.is_null())
+        return emit(Null());
+      if (!value.is_object())
+        return true;
+      if (!value.Load(error))
+        return false;
+      Document::Value member;
+      return value.find(node.name, member) ? emit({member, input.owner})
+                                           : emit(Null());
+    }
+
+    case Kind::Index: {
+      if (value.is_null())
+        return emit(Null());
+      if (!value.is_array())
+        return true;
+      if (!value.Load(error))
+        return false;
+      const int64_t size = static_cast<int64_t>(value.size());
+      const int64_t index = node.begin < 0 ? size + node.begin : node.begin;
+      if (index < 0 || index >= size)
+        return emit(Null());
+      return emit({value.child(static_cast<size_t>(index)), input.owner});
+    }
+
+    case Kind::Slice: {
+      if (value.is_null())
+        return emit(Null());
+      if (!value.is_array())
+        return true;
+      if (!value.Load(error))
+        return false;
+      const int64_t size = static_cast<int64_t>(value.size());
+      const auto clamp = [size](int64_t index) {
+        return std::clamp<int64_t>(index < 0 ? size + index : index, 0, size);
+      };
+      const int64_t begin = node.has_begin ? clamp(node.begin) : 0;
+      const int64_t end = node.has_end ? clamp(node.end) : size;
+      std::string json = "[";
+      for (int64_t i = begin; i < end; ++i) {
+        if (i != begin)
+          json += ',';
+        if (!Copy(value.child(static_cast<size_t>(i)), json, error))
+          return false;
+      }
+      json += ']';
+      return emit(Constant(std::move(json)));
+    }
+
+    case Kind::Iterate: {
+      if (!value.is_array() && !value.is_object())
+        return true;
+      if (!value.Load(error))
+        return false;
+      for (size_t i = 0; i < value.size(); ++i) {
+        if (!emit({value.child(i), input.owner}))
+          return false;
+      }
+      return true;
+    }
+
+    case Kind::Pipe:
+      return Pipe(node, 0, input, emit, error);
+
+    case Kind::Object: {
+      std::string json = "{";
+      for (size_t i = 0; i < node.keys.size(); ++i) {
+        if (i)
+          json += ',';
+        Quote(node.keys[i], json);
+        json += ':';
+        const Item member = First(*node.children[i], input, error);
+        if (!error.empty() || !Copy(member.value, json, error))
+          return false;
+      }
+      json += '}';
+      return emit(Constant(std::move(json)));
+    }
+
+    case Kind::Select: {
+      const Item predicate = First(*node.children[0], input, error);
+      if (!error.empty())
+        return false;
+      if (!Truthy(predicate.value))
+        return true;
+      return emit(input);
+    }
+
+    case Kind::Compare: {
+      const Item left = First(*node.children[0], input, error);
+      if (!error.empty())
+        return false;
+      const Item right = First(*node.children[1], input, error);
+      if (!error.empty() || !LoadAll(left.value, error) ||
+          !LoadAll(right.value, error)) {
+        return false;
+      }
+      const int order = Compare(left.value, right.value);
+      return emit(Boolean(Holds(node.name, order)));
+    }
+
+    case Kind::And:
+    case Kind::Or: {
+      const Item left = First(*node.children[0], input, error);
+      if (!error.empty())
+        return false;
+      if (Truthy(left.value) == (node.kind == Kind::Or))
+        return emit(Boolean(Truthy(left.value)));
+      const Item right = First(*node.children[1], input, error);
+      if (!error.empty())
+        return false;
+      return emit(Boolean(Truthy(right.value)));
+    }
+
+    case Kind::Literal:
+      return emit({node.literal->root(), node.literal});
+  }
+  return true;
+}
+
+// A recursive descent parser. The grammar:
+//
+//   pipe       := term ('|' term)*
+//   term       := path | object | 'select' '(' or ')'
+//   path       := '.' (name | '[' bracket ']')? suffix*
+//   suffix     := '.' name | '.'? '[' bracket ']'
+//   bracket    := <empty> | integer | integer? ':' integer? | string
+//   object     := '{' entry (',' entry)* '}'
+//   entry      := name (':' term)?
+//   or         := and ('or' and)*
+//   and        := comparison ('and' comparison)*
+//   comparison := operand (operator operand)?
+//   operand    := literal | path | '(' or ')'
+//   literal    := a JSON value
+class Parser {
+ public:
+  explicit Parser(std::string_view input) : input_(input) {}
+
+  bool Run(std::unique_ptr<Node>& out) {
+    out = ParsePipe();
+    if (!out)
+      return false;
+    SkipWhitespace();
+    if (position_ != input_.size())
+      return Fail("unexpected character");
+    return true;
+  }
+
+  std::string error() const {
+    return "invalid filter at column " + std::to_string(position_ + 1) + ": " +
+           error_;
+  }
+
+ private:
+  std::unique_ptr<Node> ParsePipe() {
+    auto node = std::make_unique<Node>();
+    node->kind = Kind::Pipe;
+    do {
+      std::unique_ptr<Node> term = ParseTerm();
+      if (!term)
+        return nullptr;
+      node->children.push_back(std::move(term));
+    } while (Consume("|"));
+    if (node->children.size() == 1)
+      return std::move(node->children[0]);
+    return node;
+  }
+
+  std::unique_ptr<Node> ParseTerm() {
+    SkipWhitespace();
+    if (Peek('{'))
+      return ParseObject();
+    if (Peek('.'))
+      return ParsePath();
+    if (ConsumeWord("select")) {
+      if (!Consume("("))
+        return FailNode("expected '('");
+      auto node = std::make_unique<Node>();
+      node->kind = Kind::Select;
+      std::unique_ptr<Node> predicate = ParseOr();
+      if (!predicate)
+        return nullptr;
+      if (!Consume(")"))
+        return FailNode("expected ')'");
+      node->children.push_back(std::move(predicate));
+      return node;
+    }
+    return FailNode("expected '.', '{' or 'select'");
+  }
+
+  std::unique_ptr<Node> ParsePath() {
+    auto node = std::make_unique<Node>();
+    node->kind = Kind::Pipe;
+    Consume(".");
+    std::string name;
+    if (ParseName(name))
+      node->children.push_back(Field(std::move(name)));
+    else if (!error_.empty())
+      return nullptr;
+
+    while (true) {
+      if (Peek('.') && !Peek('.', 1)) {
+        position_++;
+        if (Peek('['))
+          continue;
+        if (!ParseName(name))
+          return FailNode("expected a member name after '.'");
+        node->children.push_back(Field(std::move(name)));
+        continue;
+      }
+      if (!Peek('['))
+        break;
+      position_++;
+      std::unique_ptr<Node> bracket = ParseBracket();
+      if (!bracket)
+        return nullptr;
+      node->children.push_back(std::move(bracket));
+    }
+
+    if (node->children.empty())
+      node->kind = Kind::Identity;
+    else if (node->children.size() == 1)
+      return std::move(node->children[0]);
+    return node;
+  }
+
+  // After the '['.
+  std::unique_ptr<Node> ParseBracket() {
+    auto node = std::make_unique<Node>();
+    SkipWhitespace();
+    if (Consume("]")) {
+      node->kind = Kind::Iterate;
+      return node;
+    }
+    if (Peek('"')) {
+      std::string name;
+      if (!ParseString(name))
+        return nullptr;
+      if (!Consume("]"))
+        return FailNode("expected ']'");
+      return Field(std::move(name));
+    }
+    node->has_begin = ParseInteger(node->begin);
+    node->kind = Kind::Index;
+    if (Consume(":")) {
+      node->kind = Kind::Slice;
+      SkipWhitespace();
+      node->has_end = ParseInteger(node->end);
+    } else if (!node->has_begin) {
+      return FailNode("expected an index, a slice or ']'");
+    }
+    if (!Consume("]"))
+      return FailNode("expected ']'");
+    return node;
+  }
+
+  std::unique_ptr<Node> ParseObject() {
+    Consume("{");
+    auto node = std::make_unique<Node>();
+    node->kind = Kind::Object;
+    do {
+      SkipWhitespace();
+      std::string key;
+      if (!ParseName(key))
+        return FailNode("expected a member name");
+      std::unique_ptr<Node> value;
+      if (Consume(":")) {
+        value = ParseTerm();
+        if (!value)
+          return nullptr;
+      } else {
+        value = Field(key);
+      }
+      node->keys.push_back(std::move(key));
+      node->children.push_back(std::move(value));
+    } while (Consume(","));
+    if (!Consume("}"))
+      return FailNode("expected ',' or '}'");
+    return node;
+  }
+
+  std::unique_ptr<Node> ParseOr() {
+    return ParseBinary(Kind::Or, "or", [this] {
+      return ParseBinary(Kind::And, "and", [this] { return ParseCompare(); });
+    });
+  }
+
+  std::unique_ptr<Node> ParseBinary(
+      Kind kind,
+      const char* word,
+      const std::function<std::unique_ptr<Node>()>& operand) {
+    std::unique_ptr<Node> left = operand();
+    while (left && ConsumeWord(word)) {
+      std::unique_ptr<Node> right = operand();
+      if (!right)
+        return nullptr;
+      auto node = std::make_unique<Node>();
+      node->kind = kind;
+      node->children.push_back(std::move(left));
+      node->children.push_back(std::move(right));
+      left = std::move(node);
+    }
+    return left;
+  }
+
+  std::unique_ptr<Node> ParseCompare() {
+    std::unique_ptr<Node> left = ParseOperand();
+    if (!left)
+      return nullptr;
+    // The longest operators first.
+    for (const char* op : {"==", "!=", "<=", ">=", "<", ">"}) {
+      if (!Consume(op))
+        continue;
+      std::unique_ptr<Node> right = ParseOperand();
+      if (!right)
+        return nullptr;
+      auto node = std::make_unique<Node>();
+      node->kind = Kind::Compare;
+      node->name = op;
+      node->children.push_back(std::move(left));
+      node->children.push_back(std::move(right));
+      return node;
+    }
+    return left;
+  }
+
+  std::unique_ptr<Node> ParseOperand() {
+    SkipWhitespace();
+    if (Peek('.'))
+      return ParsePath();
+    if (Consume("(")) {
+      std::unique_ptr<Node> node = ParseOr();
+      if (node && !Consume(")"))
+        return FailNode("expected ')'");
+      return node;
+    }
+
+    // A literal: parsed by the document parser, up to the next delimiter.
+    const size_t begin = position_;
+    if (Peek('"')) {
+      std::string ignored;
+      if (!ParseString(ignored))
+        return nullptr;
+    } else if (Peek('[') || Peek('{')) {
+      SkipContainer();
+    } else {
+      while (position_ < input_.size() &&
+             (std::isalnum(static_cast<unsigned char>(input_[position_])) ||
+              input_[position_] == '-' || input_[position_] == '+' ||
+              input_[position_] == '.')) {
+        position_++;
+      }
+    }
+    auto node = std::make_unique<Node>();
+    node->kind = Kind::Literal;
+    node->literal =
+        ParseConstant(std::string(input_.substr(begin, position_ - begin)));
+    if (position_ == begin || !node->literal) {
+      position_ = begin;
+      return FailNode("expected a path or a literal");
+    }
+    return node;
+  }
+
+  // An identifier, or a string.
+  bool ParseName(std::string& out) {
+    if (Peek('"'))
+      return ParseString(out);
+    const size_t begin = position_;
+    while (position_ < input_.size() &&
+           (std::isalnum(static_cast<unsigned char>(input_[position_])) ||
+            input_[position_] == '_')) {
+      position_++;
+    }
+    if (position_ == begin ||
+        std::isdigit(static_cast<unsigned char>(input_[begin]))) {
+      position_ = begin;
+      return false;
+    }
+    out = std::string(input_.substr(begin, position_ - begin));
+    return true;
+  }
+
+  // A JSON string, decoded.
+  bool ParseString(std::string& out) {
+    const size_t begin = position_++;
+    while (position_ < input_.size() && input_[position_] != '"')
+      position_ += input_[position_] == '\\' ? 2 : 1;
+    if (position_ >= input_.size()) {
+      position_ = begin;
+      return Fail("unterminated string");
+    }
+    position_++;
+    std::shared_ptr<Document> string = ParseConstant(
+        std::string(input_.substr(begin, position_ - begin)));
+    if (!string) {
+      position_ = begin;
+      return Fail("invalid string");
+    }
+    out = string->root().string();
+    return true;
+  }
+
+  // A JSON array or object, up to its closing bracket. It is validated by the
+  // document parser.
+  void SkipContainer() {
+    int depth = 0;
+    bool in_string = false;
+    for (; position_ < input_.size(); ++position_) {
+      const char c = input_[position_];
+      if (in_string) {
+        if (c == '\\')
+          position_++;
+        else if (c == '"')
+          in_string = false;
+      } else if (c == '"') {
+        in_string = true;
+      } else if (c == '[' || c == '{') {
+        depth++;
+      } else if ((c == ']' || c == '}') && --depth == 0) {
+        position_++;
+        return;
+      }
+    }
+  }
+
+  bool ParseInteger(int64_t& out) {
+    SkipWhitespace();
+    char* end = nullptr;
+    const std::string rest(input_.substr(position_));
+    const long long value = std::strtoll(rest.c_str(), &end, 10);
+    if (end == rest.c_str())
+      return false;
+    position_ += static_cast<size_t>(end - rest.c_str());
+    out = value;
+    return true;
+  }
+
+  static std::unique_ptr<Node> Field(std::string name) {
+    auto node = std::make_unique<Node>();
+    node->kind = Kind::Field;
+    node->name = std::move(name);
+    return node;
+  }
+
+  void SkipWhitespace() {
+    while (position_ < input_.size() &&
+           std::isspace(static_cast<unsigned char>(input_[position_]))) {
+      position_++;
+    }
+  }
+
+  bool Peek(char c, size_t offset = 0) const {
+    return position_ + offset < input_.size() &&
+           input_[position_ + offset] == c;
+  }
+
+  bool Consume(std::string_view token) {
+    SkipWhitespace();
+    if (input_.substr(position_, token.size()) != token)
+      return false;
+    position_ += token.size();
+    return true;
+  }
+
+  // A keyword, not followed by the rest of an identifier.
+  bool ConsumeWord(std::string_view word) {
+    SkipWhitespace();
+    const size_t end = position_ + word.size();
+    if (input_.substr(position_, word.size()) != word ||
+        (end < input_.size() &&
+         (std::isalnum(static_cast<unsigned char>(input_[end])) ||
+          input_[end] == '_'))) {
+      return false;
+    }
+    position_ = end;
+    return true;
+  }
+
+  bool Fail(const char* message) {
+    if (error_.empty())
+      error_ = message;
+    return false;
+  }
+
+  std::unique_ptr<Node> FailNode(const char* message) {
+    Fail(message);
+    return nullptr;
+  }
+
+  std::string_view input_;
+  size_t position_ = 0;
+  std::string error_;
+};
+
+}  // namespace
+
+Filter::Filter() = default;
+Filter::~Filter() = default;
+Filter::Filter(Filter&&) = default;
+Filter& Filter::operator=(Filter&&) = default;
+
+// static
+bool Filter::Compile(std::string_view expression,
+                     Filter& out,
+                     std::string& error) {
+  Parser parser(expression);
+  if (!parser.Run(out.root_)) {
+    error = parser.error();
+    return false;
+  }
+  return true;
+}
+
+bool Filter::Run(const Document& document,
+                 std::string& output,
+                 size_t& count,
+                 std::string& error) const {
+  count = 0;
+  output = "[";
+  error.clear();
+  Evaluate(
+      *root_, {document.root(), nullptr},
+      [&](const Item& item) {
+        if (count++)
+          output += ',';
+        return Copy(item.value, output, error);
+      },
+      error);
+  output += ']';
+  return error.empty();
+}
@@ -0,0 +1,58 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#ifndef JSON_TUI_FILTER_HPP
+#define JSON_TUI_FILTER_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include "document.hpp"
+
+// A subset of jq (https://jqlang.github.io/jq), to display a projection of a
+// document:
+//
+//   .                    The input.
+//   .name  ."name"       The member of an object, or null.
+//   .[2]  .[-1]          An element of an array, or null.
+//   .[2:5]  .[:-1]       A slice of an array.
+//   .[]                  Each element of an array, or value of an object.
+//   a | b                b applied to each output of a.
+//   {name, "a b", x: .y} An object. A member takes the first output of its
+//                        filter, or null.
+//   select(predicate)    The input, when the predicate holds. Predicates
+//                        compare filters and JSON literals with
+//                        == != < <= > >=, combined with 'and' and 'or'. Like
+//                        jq, arrays and objects are compared by their content.
+//
+// Like jq's '?', the paths not applying to a value produce nothing instead of
+// an error. The filter only loads the containers it walks through: the rest of
+// a lazily parsed document is skipped using its structural index.
+class Filter {
+ public:
+  Filter();
+  ~Filter();
+  Filter(Filter&&);
+  Filter& operator=(Filter&&);
+
+  // On failure, return false and fill |error| with the position of the error.
+  static bool Compile(std::string_view expression,
+                      Filter& out,
+                      std::string& error);
+
+  // Apply the filter to the root of |document|. The outputs are written to
+  // |output|, as the elements of a JSON array, and counted in |count|. The
+  // containers copied to the output are validated first: on a syntax error,
+  // return false and fill |error| with its position in the input.
+  bool Run(const Document& document,
+           std::string& output,
+           size_t& count,
+           std::string& error) const;
+
+  struct Node;
+
+ private:
+  std::unique_ptr<Node> root_;
+};
+
+#endif  // JSON_TUI_FILTER_HPP
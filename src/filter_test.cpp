@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "document.hpp"
+#include "filter.hpp"
+
+namespace {
+
+// The outputs of |expression| on |input|, as a JSON array.
+std::string Apply(std::string_view expression, std::string_view input) {
+  Filter filter;
+  std::string error;
+  EXPECT_TRUE(Filter::Compile(expression, filter, error)) << error;
+  Document document;
+  EXPECT_TRUE(Document::ParseLazily(input, document, error)) << error;
+  std::string output;
+  size_t count = 0;
+  EXPECT_TRUE(filter.Run(document, output, count, error)) << error;
+  return output;
+}
+
+std::string CompileError(std::string_view expression) {
+  Filter filter;
+  std::string error;
+  EXPECT_FALSE(Filter::Compile(expression, filter, error));
+  return error;
+}
+
+}  // namespace
+
+TEST(Filter, Paths) {
+  const std::string input =
+      R"({"items": [{"name": "a", "n": 1}, {"name": "b", "n": [2]}],)"
+      R"( "a b": true})";
+  EXPECT_EQ(Apply(".", "[1, 2]"), "[[1, 2]]");
+  EXPECT_EQ(Apply(".items[1].name", input), R"(["b"])");
+  EXPECT_EQ(Apply(".items | .[0] | .n", input), "[1]");
+  EXPECT_EQ(Apply(".items[-1].n[0]", input), "[2]");
+  EXPECT_EQ(Apply(R"(."a b")", input), "[true]");
+  EXPECT_EQ(Apply(R"(.["a b"])", input), "[true]");
+  EXPECT_EQ(Apply(".missing", input), "[null]");
+  EXPECT_EQ(Apply(".items[5]", input), "[null]");
+  EXPECT_EQ(Apply(".items.name", input), "[]");
+}
+
+TEST(Filter, IterateAndSlice) {
+  EXPECT_EQ(Apply(".[]", "[1, [2], {\"a\": 3}]"), R"([1,[2],{"a": 3}])");
+  EXPECT_EQ(Apply(".[]", R"({"a": 1, "b": 2})"), "[1,2]");
+  EXPECT_EQ(Apply(".[] | .[]", "[[1, 2], 3, [4]]"), "[1,2,4]");
+  EXPECT_EQ(Apply(".[1:3]", "[0, 1, 2, 3]"), "[[1,2]]");
+  EXPECT_EQ(Apply(".[:-1]", "[0, 1, 2, 3]"), "[[0,1,2]]");
+  EXPECT_EQ(Apply(".[2:]", "[0, 1, 2, 3]"), "[[2,3]]");
+}
+
+TEST(Filter, Projection) {
+  const std::string input =
+      R"({"items": [{"name": "a", "status": {"ok": true}, "x": 1},)"
+      R"( {"name": "b\n", "x": 2}]})";
+  EXPECT_EQ(Apply(".items[] | {name, status}", input),
+            R"([{"name":"a","status":{"ok": true}},)"
+            R"({"name":"b\n","status":null}])");
+  EXPECT_EQ(Apply(R"(.items[0] | {"the name": .name, ok: .status.ok})", input),
+            R"([{"the name":"a","ok":true}])");
+  EXPECT_EQ(Apply(".items[] | {name} | .name", input), R"(["a","b\n"])");
+}
+
+TEST(Filter, Select) {
+  const std::string input =
+      R"([{"n": 1, "s": "a"}, {"n": 2.5, "s": "b"}, {"n": 10, "s": "c"},)"
+      R"( {"s": "d"}])";
+  EXPECT_EQ(Apply(".[] | select(.n > 2) | .s", input), R"(["b","c"])");
+  EXPECT_EQ(Apply(".[] | select(.n >= 1 and .n < 5) | .s", input),
+            R"(["a","b"])");
+  EXPECT_EQ(Apply(R"(.[] | select(.s == "a" or .s == "d") | .s)", input),
+            R"(["a","d"])");
+  EXPECT_EQ(Apply(".[] | select(.n == null) | .s", input), R"(["d"])");
+  EXPECT_EQ(Apply(".[] | select(.n) | .s", input), R"(["a","b","c"])");
+  EXPECT_EQ(Apply(".[] | select((.n != 1) and (.s != \"d\")) | .s", input),
+            R"(["b","c"])");
+}
+
+TEST(Filter, CompareContainers) {
+  const std::string input =
+      R"([{"a": {"x": 1, "y": [1, 2]}}, {"a": { "y" : [1,2], "x":1 }},)"
+      R"( {"a": {"x": 1}}, {"a": [1, 3]}, {"a": [1, 2, 0]}])";
+  EXPECT_EQ(Apply(R"(.[] | select(.a == {"y": [1, 2], "x": 1}) | .a.x)",
+                  input),
+            "[1,1]");
+  // Element by element, then by size.
+  EXPECT_EQ(Apply(".[] | select(.a > [1, 2]) | .a", input),
+            "[{\"x\": 1, \"y\": [1, 2]},{ \"y\" : [1,2], \"x\":1 },"
+            "{\"x\": 1},[1, 3],[1, 2, 0]]");
+  EXPECT_EQ(Apply(".[] | select(.a < [1, 2, 1]) | .a", input), "[[1, 2, 0]]");
+  // By the sorted keys, then by the values. The arrays come first.
+  EXPECT_EQ(Apply(R"(.[] | select(.a < {"x": 2}) | .a)", input),
+            R"([{"x": 1},[1, 3],[1, 2, 0]])");
+  EXPECT_EQ(Apply(R"(.[] | select(.a > {"x": 1, "y": [1]}) | .a.x)", input),
+            "[1,1]");
+}
+
+TEST(Filter, Lazy) {
+  Filter filter;
+  std::string error;
+  ASSERT_TRUE(Filter::Compile(".[1].a", filter, error)) << error;
+  Document document;
+  ASSERT_TRUE(Document::ParseLazily(R"([{"a": [1]}, {"a": 2}])", document,
+                                    error));
+  std::string output;
+  size_t count = 0;
+  EXPECT_TRUE(filter.Run(document, output, count, error)) << error;
+  EXPECT_EQ(count, 1u);
+  EXPECT_EQ(output, "[2]");
+  EXPECT_FALSE(document.root().child(0).loaded());
+}
+
+// The syntax errors in the skipped containers are located in the input.
+TEST(Filter, InvalidInput) {
+  const std::string input = "[\n  [1, 2],\n  {\"a\": [1, tru]}\n]";
+  for (const char* expression :
+       {".", ".[1:]", ".[1] | {a}", ".[1].a", ".[] | select(. == [1, 2])"}) {
+    Filter filter;
+    std::string error;
+    ASSERT_TRUE(Filter::Compile(expression, filter, error)) << error;
+    Document document;
+    ASSERT_TRUE(Document::ParseLazily(input, document, error)) << error;
+    std::string output;
+    size_t count = 0;
+    EXPECT_FALSE(filter.Run(document, output, count, error)) << expression;
+    EXPECT_EQ(error.rfind("parse error at line 3, column ", 0), 0u)
+        << expression << ": " << error;
+  }
+}
+
+TEST(Filter, Errors) {
+  EXPECT_EQ(CompileError("items"),
+            "invalid filter at column 1: expected '.', '{' or 'select'");
+  EXPECT_EQ(CompileError(".a |"),
+            "invalid filter at column 5: expected '.', '{' or 'select'");
+  EXPECT_EQ(CompileError(".[1"), "invalid filter at column 4: expected ']'");
+  EXPECT_EQ(CompileError("{a"),
+            "invalid filter at column 3: expected ',' or '}'");
+  EXPECT_EQ(CompileError("select(.a == )"),
+            "invalid filter at column 14: expected a path or a literal");
+  EXPECT_EQ(CompileError(".a b"),
+            "invalid filter at column 4: unexpected character");
+  CompileError(".\"a");
+  CompileError(".[]x");
+}
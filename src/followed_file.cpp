@@ -0,0 +1,87 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+
+#include "followed_file.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <system_error>
+#include <thread>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// static
+FollowedFilePtr FollowedFile::Open(const std::string& path) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file)
+    return nullptr;
+  auto followed = FollowedFilePtr(new FollowedFile());
+  followed->path_ = path;
+  followed->file_ = file;
+#if defined(__linux__)
+  // Without inotify, for instance when the limit of watches is reached, the
+  // file is polled.
+  followed->inotify_ = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+  if (followed->inotify_ >= 0 &&
+      inotify_add_watch(followed->inotify_, path.c_str(),
+                        IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF |
+                            IN_DELETE_SELF) < 0) {
+    close(followed->inotify_);
+    followed->inotify_ = -1;
+  }
+#endif
+  return followed;
+}
+
+FollowedFile::~FollowedFile() {
+  fclose(file_);
+#if defined(__linux__)
+  if (inotify_ >= 0)
+    close(inotify_);
+#endif
+}
+
+size_t FollowedFile::Read(char* buffer, size_t size) {
+  while (true) {
+    const size_t read = fread(buffer, 1, size, file_);
+    if (read) {
+      position_ += read;
+      return read;
+    }
+    if (ferror(file_) || Truncated())
+      return 0;
+    // At the end of the file. Try again once it changed.
+    clearerr(file_);
+    Wait();
+  }
+}
+
+void FollowedFile::Wait() {
+#if defined(__linux__)
+  if (inotify_ >= 0) {
+    // The events are queued since the watch was added, so a write between
+    // the last read and the poll isn't missed. The timeout only bounds how
+    // late a replaced file is noticed.
+    pollfd descriptor = {inotify_, POLLIN, 0};
+    if (poll(&descriptor, 1, kPollMilliseconds) > 0) {
+      // Drain the events. Their content doesn't matter.
+      alignas(inotify_event) char events[4096];
+      while (read(inotify_, events, sizeof(events)) > 0) {
+      }
+    }
+    return;
+  }
+#endif
+  std::this_thread::sleep_for(std::chrono::milliseconds(kPollMilliseconds));
+}
+
+bool FollowedFile::Truncated() const {
+  std::error_code error;
+  const uintmax_t size = std::filesystem::file_size(path_, error);
+  return error || size < position_;
+}
@@ -0,0 +1,53 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#ifndef JSON_TUI_FOLLOWED_FILE_HPP
+#define JSON_TUI_FOLLOWED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+class FollowedFile;
+using FollowedFilePtr = std::unique_ptr<FollowedFile>;
+
+// A file read like `tail -f`: at its end, Read() waits for bytes to be
+// appended instead of returning. Only the new bytes are read. The file is
+// watched with inotify on Linux, and polled elsewhere.
+class FollowedFile {
+ public:
+  // Returns nullptr when the file can't be opened.
+  static FollowedFilePtr Open(const std::string& path);
+  ~FollowedFile();
+
+  FollowedFile(const FollowedFile&) = delete;
+  FollowedFile& operator=(const FollowedFile&) = delete;
+
+  // Read up to |size| bytes into |buffer|, blocking until some are available.
+  // Return 0 when the file can't be followed anymore: when it was truncated,
+  // for instance rotated, or on error.
+  size_t Read(char* buffer, size_t size);
+
+  // The time waited for a change before checking the file again. Also the
+  // polling period, without inotify.
+  static constexpr int kPollMilliseconds = 250;
+
+ private:
+  FollowedFile() = default;
+
+  // Block until the file might have changed.
+  void Wait();
+  // Whether the file is shorter than what was read.
+  bool Truncated() const;
+
+  std::string path_;
+  FILE* file_ = nullptr;
+  uint64_t position_ = 0;
+#if defined(__linux__)
+  int inotify_ = -1;
+#endif
+};
+
+#endif  // JSON_TUI_FOLLOWED_FILE_HPP
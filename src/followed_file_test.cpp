@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include "followed_file.hpp"
+
+namespace {
+
+std::string Path(const std::string& name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+void Write(const std::string& path, const std::string& content, bool append) {
+  FILE* file = fopen(path.c_str(), append ? "ab" : "wb");
+  EXPECT_TRUE(file);
+  fwrite(content.data(), 1, content.size(), file);
+  fclose(file);
+}
+
+std::string ReadSome(FollowedFile& file) {
+  char buffer[64];
+  return std::string(buffer, file.Read(buffer, sizeof(buffer)));
+}
+
+}  // namespace
+
+TEST(FollowedFile, Append) {
+  const std::string path = Path("json_tui_followed_file_append.json");
+  Write(path, "[1,", /*append=*/false);
+  FollowedFilePtr file = FollowedFile::Open(path);
+  ASSERT_TRUE(file);
+  EXPECT_EQ(ReadSome(*file), "[1,");
+
+  // The reader waits for the next write.
+  std::thread writer([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    Write(path, "2,", /*append=*/true);
+  });
+  EXPECT_EQ(ReadSome(*file), "2,");
+  writer.join();
+
+  // A truncated file ends.
+  Write(path, "", /*append=*/false);
+  EXPECT_EQ(ReadSome(*file), "");
+  std::remove(path.c_str());
+}
+
+TEST(FollowedFile, Missing) {
+  EXPECT_FALSE(FollowedFile::Open(Path("json_tui_followed_file_missing")));
+}
@@ -0,0 +1,160 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+
+#include "index_cache.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <type_traits>
+#include "mapped_file.hpp"
+
+namespace {
+
+constexpr char kMagic[8] = {'J', 'S', 'O', 'N', 'T', 'U', 'I', 'X'};
+constexpr uint32_t kByteOrder = 0x01020304;
+
+// The blocks hashed to detect a modified content. Smaller files are hashed
+// entirely.
+constexpr size_t kSampleCount = 64;
+constexpr size_t kSampleSize = 4096;
+
+// The file begins with this header. The tape follows, then the structural
+// index. Both are arrays of records, used in place once the file is mapped.
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t path_hash;
+  uint64_t input_size;
+  int64_t modification_time;
+  uint64_t content_hash;
+  uint64_t tape_size;        // In bytes.
+  uint64_t containers_size;  // In bytes.
+};
+static_assert(sizeof(Header) % Document::kSnapshotAlignment == 0,
+              "The tape must stay aligned.");
+static_assert(std::has_unique_object_representations_v<Header>,
+              "The header is written as is: it must have no padding.");
+
+// FNV-1a.
+uint64_t Hash(std::string_view data, uint64_t hash = 14695981039346656037u) {
+  for (const char c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211u;
+  }
+  return hash;
+}
+
+uint64_t HashContent(std::string_view input) {
+  if (input.size() <= kSampleCount * kSampleSize)
+    return Hash(input);
+  uint64_t hash = Hash({});
+  const size_t last = input.size() - kSampleSize;
+  for (size_t i = 0; i < kSampleCount; ++i) {
+    const size_t begin = last * i / (kSampleCount - 1);
+    hash = Hash(input.substr(begin, kSampleSize), hash);
+  }
+  return hash;
+}
+
+// The key of the file at |path|, whose content is |input|. Return false when
+// the file can't be found.
+bool MakeHeader(const std::string& path,
+                std::string_view input,
+                Header& header) {
+  std::error_code error;
+  const std::filesystem::path absolute = std::filesystem::absolute(path, error);
+  if (error)
+    return false;
+  const auto time = std::filesystem::last_write_time(path, error);
+  if (error)
+    return false;
+
+  header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = Document::kSnapshotVersion;
+  header.byte_order = kByteOrder;
+  header.path_hash = Hash(absolute.string());
+  header.input_size = input.size();
+  header.modification_time = time.time_since_epoch().count();
+  header.content_hash = HashContent(input);
+  return true;
+}
+
+}  // namespace
+
+std::string IndexCachePath(const std::string& path) {
+  return path + ".json-tui-index";
+}
+
+bool LoadIndexCache(const std::string& path,
+                    std::string_view input,
+                    Document& out) {
+  Header expected;
+  if (!MakeHeader(path, input, expected))
+    return false;
+  std::shared_ptr<MappedFile> cache = MappedFile::Open(IndexCachePath(path));
+  if (!cache || cache->content().size() < sizeof(Header))
+    return false;
+
+  const std::string_view content = cache->content();
+  Header header;
+  std::memcpy(&header, content.data(), sizeof(Header));
+  header.tape_size = 0;
+  header.containers_size = 0;
+  if (std::memcmp(&header, &expected, sizeof(Header)) != 0)
+    return false;
+
+  std::memcpy(&header, content.data(), sizeof(Header));
+  const size_t available = content.size() - sizeof(Header);
+  if (header.tape_size > available ||
+      header.containers_size != available - header.tape_size) {
+    return false;
+  }
+  Document::Snapshot snapshot;
+  snapshot.tape = content.substr(sizeof(Header), header.tape_size);
+  snapshot.containers = content.substr(sizeof(Header) + header.tape_size);
+  return Document::FromSnapshot(input, snapshot, std::move(cache), out);
+}
+
+// The cache is written next to the file and renamed, so that a process
+// reading it concurrently never sees it partially written.
+bool SaveIndexCache(const std::string& path,
+                    const Document& document,
+                    std::string& error) {
+  const std::string cache_path = IndexCachePath(path);
+  Header header;
+  if (!MakeHeader(path, document.input(), header)) {
+    error = "Could not find " + path;
+    return false;
+  }
+  const Document::Snapshot snapshot = document.snapshot();
+  header.tape_size = snapshot.tape.size();
+  header.containers_size = snapshot.containers.size();
+
+  const std::string temporary_path = cache_path + ".tmp";
+  FILE* file = fopen(temporary_path.c_str(), "wb");
+  bool written = file && fwrite(&header, sizeof(header), 1, file) == 1 &&
+                 fwrite(snapshot.tape.data(), 1, snapshot.tape.size(),
+                        file) == snapshot.tape.size() &&
+                 fwrite(snapshot.containers.data(), 1,
+                        snapshot.containers.size(),
+                        file) == snapshot.containers.size();
+  if (file)
+    written = fclose(file) == 0 && written;
+#if defined(_WIN32)
+  // Unlike POSIX, Windows doesn't replace an existing file.
+  if (written)
+    std::remove(cache_path.c_str());
+#endif
+  if (!written || std::rename(temporary_path.c_str(), cache_path.c_str())) {
+    std::remove(temporary_path.c_str());
+    error = "Could not write " + cache_path;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,33 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#ifndef JSON_TUI_INDEX_CACHE_HPP
+#define JSON_TUI_INDEX_CACHE_HPP
+
+#include <string>
+#include <string_view>
+#include "document.hpp"
+
+// An opt-in cache of the structural index of a file, stored next to it. The
+// second time a large file is opened, the cache is mapped in memory instead of
+// scanning and parsing the file again. Only the pages of the containers being
+// expanded are read.
+//
+// The cache is keyed by the absolute path of the file, its size, its
+// modification time, and a hash of blocks sampled across its content.
+
+// The path of the cache of the file at |path|.
+std::string IndexCachePath(const std::string& path);
+
+// Reopen the document of the file at |path|, whose content is |input|, from
+// its cache. Return false when there is no cache, or when it is outdated.
+bool LoadIndexCache(const std::string& path,
+                    std::string_view input,
+                    Document& out);
+
+// Write the cache of the file at |path|, given its lazily parsed |document|.
+bool SaveIndexCache(const std::string& path,
+                    const Document& document,
+                    std::string& error);
+
+#endif  // JSON_TUI_INDEX_CACHE_HPP
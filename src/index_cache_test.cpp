@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include "document.hpp"
+#include "index_cache.hpp"
+#include "json_generator.hpp"
+#include "mapped_file.hpp"
+
+namespace {
+
+std::string Write(const std::string& name, const std::string& content) {
+  const std::string path =
+      (std::filesystem::temp_directory_path() / name).string();
+  FILE* file = fopen(path.c_str(), "wb");
+  EXPECT_TRUE(file);
+  fwrite(content.data(), 1, content.size(), file);
+  fclose(file);
+  return path;
+}
+
+std::string Read(const std::string& path) {
+  MappedFilePtr file = MappedFile::Open(path);
+  EXPECT_TRUE(file);
+  return file ? std::string(file->content()) : "";
+}
+
+void Remove(const std::string& path) {
+  std::remove(path.c_str());
+  std::remove(IndexCachePath(path).c_str());
+}
+
+}  // namespace
+
+TEST(IndexCache, Reopen) {
+  const std::string path = Write("json_tui_index_cache_reopen.json",
+                                 GenerateJSON(Shape::Deep, 1 << 20));
+  MappedFilePtr file = MappedFile::Open(path);
+  ASSERT_TRUE(file);
+  const std::string_view input = file->content();
+
+  Document document;
+  std::string error;
+  EXPECT_FALSE(LoadIndexCache(path, input, document));
+  ASSERT_TRUE(Document::ParseLazily(input, document, error)) << error;
+  ASSERT_TRUE(SaveIndexCache(path, document, error)) << error;
+
+  Document cached;
+  ASSERT_TRUE(LoadIndexCache(path, input, cached));
+  ASSERT_EQ(cached.size(), document.size());
+  const Document::Value root = document.root();
+  const Document::Value cached_root = cached.root();
+  ASSERT_EQ(cached_root.size(), root.size());
+  for (size_t i = 0; i < root.size(); ++i) {
+    const Document::Value a = root.child(i);
+    const Document::Value b = cached_root.child(i);
+    ASSERT_EQ(a.offset(), b.offset());
+    ASSERT_EQ(a.size(), b.size());
+    if (a.size()) {
+      ASSERT_EQ(a.child(0).offset(), b.child(0).offset());
+    }
+  }
+  Remove(path);
+}
+
+TEST(IndexCache, Outdated) {
+  const std::string path = Write("json_tui_index_cache_outdated.json",
+                                 R"({"a": [1, 2], "b": {"c": 3}})");
+  Document document;
+  std::string error;
+  {
+    MappedFilePtr file = MappedFile::Open(path);
+    ASSERT_TRUE(Document::ParseLazily(file->content(), document, error));
+    ASSERT_TRUE(SaveIndexCache(path, document, error)) << error;
+    EXPECT_TRUE(LoadIndexCache(path, file->content(), document));
+  }
+
+  // Same size, different content.
+  Write("json_tui_index_cache_outdated.json", R"({"a": [1, 2], "b": [[3]]})");
+  MappedFilePtr file = MappedFile::Open(path);
+  EXPECT_FALSE(LoadIndexCache(path, file->content(), document));
+
+  // Truncated.
+  Write("json_tui_index_cache_outdated.json.json-tui-index", "JSONTUIX");
+  EXPECT_FALSE(LoadIndexCache(path, file->content(), document));
+  Remove(path);
+}
+
+// The records have no uninitialized padding: the same document is always
+// saved to the same bytes.
+TEST(IndexCache, Deterministic) {
+  const std::string path = Write("json_tui_index_cache_deterministic.json",
+                                 GenerateJSON(Shape::Table, 1 << 16));
+  MappedFilePtr file = MappedFile::Open(path);
+  ASSERT_TRUE(file);
+  std::string saved[2];
+  for (std::string& bytes : saved) {
+    Document document;
+    std::string error;
+    ASSERT_TRUE(Document::ParseLazily(file->content(), document, error));
+    ASSERT_TRUE(document.Load(document.root().child(0), error)) << error;
+    ASSERT_TRUE(SaveIndexCache(path, document, error)) << error;
+    bytes = Read(IndexCachePath(path));
+  }
+  EXPECT_FALSE(saved[0].empty());
+  EXPECT_EQ(saved[0], saved[1]);
+  Remove(path);
+}
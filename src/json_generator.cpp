@@ -0,0 +1,165 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+
+#include "json_generator.hpp"
+
+#include <cstdint>
+
+namespace {
+
+// The nesting depth of the Deep documents.
+constexpr int kDepth = 64;
+
+// A small linear congruential generator. The standard distributions are not
+// specified precisely enough to give the same output on every platform.
+class Random {
+ public:
+  uint32_t Next() {
+    state_ = state_ * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<uint32_t>(state_ >> 33);
+  }
+  uint32_t Next(uint32_t bound) { return Next() % bound; }
+
+ private:
+  uint64_t state_ = 42;
+};
+
+void AppendWord(Random& random, std::string& out) {
+  static const char* const kWords[] = {
+      "lorem", "ipsum",      "dolor", "sit", "amet",    "consectetur",
+      "adipiscing", "elit", "sed",   "do",  "eiusmod", "tempor",
+  };
+  out += kWords[random.Next(sizeof(kWords) / sizeof(kWords[0]))];
+}
+
+void AppendNumber(Random& random, std::string& out) {
+  switch (random.Next(3)) {
+    case 0:
+      out += std::to_string(random.Next());
+      break;
+    case 1:
+      out += "-" + std::to_string(random.Next(1000)) + "." +
+             std::to_string(random.Next(1000000));
+      break;
+    default:
+      out += std::to_string(random.Next(100)) + "." +
+             std::to_string(random.Next(100)) + "e" +
+             std::to_string(static_cast<int>(random.Next(40)) - 20);
+      break;
+  }
+}
+
+void AppendString(Random& random, std::string& out) {
+  out += '"';
+  const uint32_t words = 4 + random.Next(60);
+  for (uint32_t i = 0; i < words; ++i) {
+    if (i != 0)
+      out += ' ';
+    switch (random.Next(16)) {
+      case 0:
+        out += "\\\"quoted\\\"";
+        break;
+      case 1:
+        out += "caf\xC3\xA9";
+        break;
+      case 2:
+        out += "\\u00e9t\\u00e9";
+        break;
+      case 3:
+        out += "line\\nbreak";
+        break;
+      default:
+        AppendWord(random, out);
+        break;
+    }
+  }
+  out += '"';
+}
+
+void AppendDeep(Random& random, std::string& out) {
+  for (int depth = 0; depth < kDepth; ++depth)
+    out += depth % 2 ? "[" : R"({"a": )";
+  AppendNumber(random, out);
+  for (int depth = kDepth - 1; depth >= 0; --depth)
+    out += depth % 2 ? "]" : "}";
+}
+
+void AppendRow(Random& random, size_t index, std::string& out) {
+  out += R"({"id": )" + std::to_string(index) + R"(, "name": ")";
+  AppendWord(random, out);
+  out += R"(", "score": )";
+  AppendNumber(random, out);
+  out += R"(, "active": )";
+  out += random.Next(2) ? "true" : "false";
+  out += R"(, "tags": [")";
+  AppendWord(random, out);
+  out += R"("], "parent": )";
+  out += random.Next(4) ? std::to_string(random.Next(1000)) : "null";
+  out += "}";
+}
+
+}  // namespace
+
+const char* ShapeName(Shape shape) {
+  switch (shape) {
+    case Shape::Deep:
+      return "Deep";
+    case Shape::Wide:
+      return "Wide";
+    case Shape::Strings:
+      return "Strings";
+    case Shape::Numbers:
+      return "Numbers";
+    case Shape::Table:
+      return "Table";
+  }
+  return "";
+}
+
+std::string GenerateJSON(Shape shape, size_t size) {
+  Random random;
+  std::string out;
+  out.reserve(size + 1024);
+  const bool object = shape == Shape::Wide;
+  out += object ? "{" : "[";
+  for (size_t i = 0; out.size() < size; ++i) {
+    if (i != 0)
+      out += ",";
+    out += "\n  ";
+    switch (shape) {
+      case Shape::Deep:
+        AppendDeep(random, out);
+        break;
+      case Shape::Wide:
+        out += "\"key_" + std::to_string(i) + "\": ";
+        AppendString(random, out);
+        break;
+      case Shape::Strings:
+        AppendString(random, out);
+        break;
+      case Shape::Numbers:
+        AppendNumber(random, out);
+        break;
+      case Shape::Table:
+        AppendRow(random, i, out);
+        break;
+    }
+  }
+  out += object ? "\n}" : "\n]";
+  return out;
+}
+
+const std::string& CachedJSON(Shape shape, size_t size) {
+  static Shape cached_shape;
+  static size_t cached_size = 0;
+  static std::string cached;
+  if (cached_size != size || cached_shape != shape) {
+    cached.clear();
+    cached.shrink_to_fit();
+    cached = GenerateJSON(shape, size);
+    cached_shape = shape;
+    cached_size = size;
+  }
+  return cached;
+}
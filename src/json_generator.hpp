@@ -0,0 +1,29 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#ifndef JSON_TUI_JSON_GENERATOR_HPP
+#define JSON_TUI_JSON_GENERATOR_HPP
+
+#include <cstddef>
+#include <string>
+
+// The shapes of the synthetic documents used to measure json-tui.
+enum class Shape {
+  Deep,     // Arrays of deeply nested objects and arrays.
+  Wide,     // A single object with a member per line.
+  Strings,  // An array of long strings, with escapes and non-ASCII text.
+  Numbers,  // An array of integers and floating point numbers.
+  Table,    // An array of objects sharing the same keys.
+};
+
+const char* ShapeName(Shape shape);
+
+// Generate a valid JSON document of about |size| bytes. The output only depends
+// on the arguments, so that measures are comparable across runs and machines.
+std::string GenerateJSON(Shape shape, size_t size);
+
+// Same as above, but the last document is kept and reused. Documents can be
+// gigabytes, so only one is kept.
+const std::string& CachedJSON(Shape shape, size_t size);
+
+#endif  // JSON_TUI_JSON_GENERATOR_HPP
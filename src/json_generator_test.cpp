@@ -0,0 +1,27 @@
+#include <gtest/gtest.h>
+#include "document.hpp"
+#include "json_generator.hpp"
+
+TEST(JsonGenerator, Valid) {
+  for (Shape shape : {Shape::Deep, Shape::Wide, Shape::Strings, Shape::Numbers,
+                      Shape::Table}) {
+    for (size_t size : {size_t(1) << 10, size_t(1) << 20}) {
+      const std::string json = GenerateJSON(shape, size);
+      EXPECT_GE(json.size(), size) << ShapeName(shape);
+      EXPECT_LT(json.size(), size + 1024) << ShapeName(shape);
+
+      Document document;
+      std::string error;
+      EXPECT_TRUE(Document::Parse(json, document, error))
+          << ShapeName(shape) << ": " << error;
+      EXPECT_EQ(document.root().is_object(), shape == Shape::Wide);
+    }
+  }
+}
+
+TEST(JsonGenerator, Deterministic) {
+  EXPECT_EQ(GenerateJSON(Shape::Table, 1 << 12),
+            GenerateJSON(Shape::Table, 1 << 12));
+  EXPECT_NE(GenerateJSON(Shape::Table, 1 << 12),
+            GenerateJSON(Shape::Strings, 1 << 12));
+}
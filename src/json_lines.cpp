@@ -0,0 +1,79 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+
+#include "json_lines.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+namespace {
+
+// Inputs smaller than this are indexed by a single thread.
+constexpr size_t kChunkSize = 16 << 20;
+
+bool IsBlank(std::string_view input, size_t begin) {
+  for (size_t i = begin; i < input.size(); ++i) {
+    const char c = input[i];
+    if (c == '\n')
+      return true;
+    if (c != ' ' && c != '\t' && c != '\r')
+      return false;
+  }
+  return true;
+}
+
+// Append the records following the line feeds in [begin, end).
+void IndexRange(std::string_view input,
+                size_t begin,
+                size_t end,
+                std::vector<uint64_t>& out) {
+  const char* data = input.data();
+  size_t position = begin;
+  while (position < end) {
+    const void* found = std::memchr(data + position, '\n', end - position);
+    if (!found)
+      break;
+    position = static_cast<const char*>(found) - data + 1;
+    if (position < input.size() && !IsBlank(input, position))
+      out.push_back(position);
+  }
+}
+
+}  // namespace
+
+std::vector<uint64_t> IndexLines(std::string_view input) {
+  const size_t chunks = std::max<size_t>(
+      1, std::min<size_t>(std::thread::hardware_concurrency(),
+                          input.size() / kChunkSize));
+  const size_t chunk_size = input.size() / chunks + 1;
+
+  std::vector<std::vector<uint64_t>> parts(chunks);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < chunks; ++i) {
+    const size_t begin = i * chunk_size;
+    const size_t end = std::min(input.size(), begin + chunk_size);
+    threads.emplace_back(IndexRange, input, begin, end, std::ref(parts[i]));
+  }
+
+  std::vector<uint64_t> lines;
+  if (!input.empty() && !IsBlank(input, 0))
+    lines.push_back(0);
+  IndexRange(input, 0, std::min(input.size(), chunk_size), lines);
+
+  for (auto& thread : threads)
+    thread.join();
+  for (size_t i = 1; i < chunks; ++i)
+    lines.insert(lines.end(), parts[i].begin(), parts[i].end());
+  return lines;
+}
+
+std::string_view LineAt(std::string_view input, uint64_t offset) {
+  std::string_view line = input.substr(offset);
+  line = line.substr(0, line.find('\n'));
+  if (!line.empty() && line.back() == '\r')
+    line.remove_suffix(1);
+  return line;
+}
@@ -0,0 +1,21 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#ifndef JSON_TUI_JSON_LINES_HPP
+#define JSON_TUI_JSON_LINES_HPP
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// JSON Lines (https://jsonlines.org): one JSON value per line, as written by
+// most loggers.
+
+// Return the position of the first byte of every record. Blank lines are
+// skipped. Large inputs are split into chunks indexed in parallel.
+std::vector<uint64_t> IndexLines(std::string_view input);
+
+// The record starting at |offset|, without its line terminator.
+std::string_view LineAt(std::string_view input, uint64_t offset);
+
+#endif  // JSON_TUI_JSON_LINES_HPP
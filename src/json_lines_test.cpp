@@ -0,0 +1,29 @@
+#include <gtest/gtest.h>
+#include "json_lines.hpp"
+
+TEST(JsonLines, Index) {
+  const std::string input = "{\"a\": 1}\n\n  \r\n[2]\r\n3\n  \"four\"";
+  auto lines = IndexLines(input);
+  ASSERT_EQ(lines, (std::vector<uint64_t>{0, 14, 19, 21}));
+  EXPECT_EQ(LineAt(input, lines[0]), "{\"a\": 1}");
+  EXPECT_EQ(LineAt(input, lines[1]), "[2]");
+  EXPECT_EQ(LineAt(input, lines[2]), "3");
+  EXPECT_EQ(LineAt(input, lines[3]), "  \"four\"");
+
+  EXPECT_TRUE(IndexLines("").empty());
+  EXPECT_TRUE(IndexLines("\n\n").empty());
+  EXPECT_EQ(IndexLines("1\n"), (std::vector<uint64_t>{0}));
+}
+
+TEST(JsonLines, Large) {
+  // Big enough to be split into several chunks.
+  std::string input;
+  std::vector<uint64_t> expected;
+  for (int i = 0; input.size() < (64 << 20); ++i) {
+    expected.push_back(input.size());
+    input += "{\"id\": " + std::to_string(i) + "}\n";
+    if (i % 7 == 0)
+      input += "\n";
+  }
+  EXPECT_EQ(IndexLines(input), expected);
+}
@@ -0,0 +1,112 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+
+#include "json_pointer.hpp"
+
+#include <limits>
+
+namespace {
+
+// Array indices are written without leading zeros. "-", past the last
+// element, designates nothing to display.
+bool ParseIndex(const std::string& token, size_t& index) {
+  if (token.empty() || (token.size() > 1 && token[0] == '0'))
+    return false;
+  index = 0;
+  for (const char c : token) {
+    if (c < '0' || c > '9')
+      return false;
+    if (index > (std::numeric_limits<size_t>::max() - 9) / 10)
+      return false;
+    index = index * 10 + static_cast<size_t>(c - '0');
+  }
+  return true;
+}
+
+}  // namespace
+
+bool ParsePointer(std::string_view pointer,
+                  std::vector<std::string>& tokens,
+                  std::string& error) {
+  tokens.clear();
+  if (pointer.empty())
+    return true;
+  if (pointer[0] != '/') {
+    error = "a JSON pointer must begin with '/'";
+    return false;
+  }
+  for (size_t i = 0; i < pointer.size(); ++i) {
+    const char c = pointer[i];
+    if (c == '/') {
+      tokens.emplace_back();
+      continue;
+    }
+    if (c != '~') {
+      tokens.back() += c;
+      continue;
+    }
+    const char next = i + 1 < pointer.size() ? pointer[i + 1] : '\0';
+    if (next != '0' && next != '1') {
+      error = "invalid escape sequence in the JSON pointer: '~' must be "
+              "followed by '0' or '1'";
+      return false;
+    }
+    tokens.back() += next == '0' ? '~' : '/';
+    i++;
+  }
+  return true;
+}
+
+bool ResolvePointer(const Document& document,
+                    std::string_view pointer,
+                    PointerPath& out,
+                    std::string& error) {
+  if (!ParsePointer(pointer, out.tokens, error))
+    return false;
+  out.values = {document.root()};
+  std::string location;
+  for (const std::string& token : out.tokens) {
+    const Document::Value parent = out.values.back();
+    if (!parent.Load(error))
+      return false;
+    Document::Value child;
+    size_t index = 0;
+    if (parent.is_object()) {
+      if (!parent.find(token, child)) {
+        error = "no member \"" + token + "\" in " +
+                (location.empty() ? "the root" : location);
+        return false;
+      }
+    } else if (parent.is_array()) {
+      if (!ParseIndex(token, index) || index >= parent.size()) {
+        error = "no element " + token + " in " +
+                (location.empty() ? "the root" : location) + ", of size " +
+                std::to_string(parent.size());
+        return false;
+      }
+      child = parent.child(index);
+    } else {
+      error = (location.empty() ? "the root" : location) +
+              " is neither an object nor an array";
+      return false;
+    }
+    location += "/" + EscapePointerToken(token);
+    out.values.push_back(child);
+  }
+  return true;
+}
+
+std::string EscapePointerToken(std::string_view token) {
+  std::string out;
+  out.reserve(token.size());
+  for (const char c : token) {
+    if (c == '~')
+      out += "~0";
+    else if (c == '/')
+      out += "~1";
+    else
+      out += c;
+  }
+  return out;
+}
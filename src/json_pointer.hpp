@@ -0,0 +1,39 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#ifndef JSON_TUI_JSON_POINTER_HPP
+#define JSON_TUI_JSON_POINTER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "document.hpp"
+
+// JSON Pointer (RFC 6901): "/items/1234/status" designates a value of a
+// document. The empty pointer designates the root.
+
+// The value designated by a pointer, and the values on the way to it.
+struct PointerPath {
+  // The decoded reference tokens.
+  std::vector<std::string> tokens;
+  // From the root to the value. One more than |tokens|.
+  std::vector<Document::Value> values;
+};
+
+// Split |pointer| into its reference tokens, with "~1" and "~0" decoded.
+bool ParsePointer(std::string_view pointer,
+                  std::vector<std::string>& tokens,
+                  std::string& error);
+
+// Find the value designated by |pointer| in |document|. Only the containers on
+// the way are loaded: their siblings are skipped using the structural index.
+// On failure, return false and fill |error| with the first token not found.
+bool ResolvePointer(const Document& document,
+                    std::string_view pointer,
+                    PointerPath& out,
+                    std::string& error);
+
+// Escape '~' and '/' in |token|.
+std::string EscapePointerToken(std::string_view token);
+
+#endif  // JSON_TUI_JSON_POINTER_HPP
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "document.hpp"
+#include "json_pointer.hpp"
+
+TEST(JSONPointer, Parse) {
+  std::vector<std::string> tokens;
+  std::string error;
+  EXPECT_TRUE(ParsePointer("", tokens, error));
+  EXPECT_TRUE(tokens.empty());
+  EXPECT_TRUE(ParsePointer("/a~1b/~0c/", tokens, error));
+  EXPECT_EQ(tokens, (std::vector<std::string>{"a/b", "~c", ""}));
+  EXPECT_EQ(EscapePointerToken("a/b~c"), "a~1b~0c");
+
+  EXPECT_FALSE(ParsePointer("a", tokens, error));
+  EXPECT_FALSE(ParsePointer("/a~2", tokens, error));
+  EXPECT_FALSE(ParsePointer("/a~", tokens, error));
+}
+
+TEST(JSONPointer, Resolve) {
+  const std::string input =
+      R"({"items": [{"a": 1}, {"status": {"café": [true]}}], "": 2})";
+  Document document;
+  std::string error;
+  ASSERT_TRUE(Document::ParseLazily(input, document, error)) << error;
+
+  PointerPath path;
+  ASSERT_TRUE(ResolvePointer(document, "/items/1/status/café/0", path, error))
+      << error;
+  ASSERT_EQ(path.values.size(), 6u);
+  EXPECT_TRUE(path.values[5].boolean());
+  EXPECT_EQ(path.values[3].key(), "status");
+  // The sibling of the path isn't loaded.
+  EXPECT_FALSE(document.root().child(0).child(0).loaded());
+
+  ASSERT_TRUE(ResolvePointer(document, "/", path, error)) << error;
+  EXPECT_EQ(path.values.back().lexeme(), "2");
+  ASSERT_TRUE(ResolvePointer(document, "", path, error)) << error;
+  EXPECT_EQ(path.values.size(), 1u);
+
+  EXPECT_FALSE(ResolvePointer(document, "/items/2", path, error));
+  EXPECT_EQ(error, "no element 2 in /items, of size 2");
+  EXPECT_FALSE(ResolvePointer(document, "/items/01", path, error));
+  EXPECT_FALSE(ResolvePointer(document, "/items/1/x", path, error));
+  EXPECT_EQ(error, "no member \"x\" in /items/1");
+  EXPECT_FALSE(ResolvePointer(document, "//x", path, error));
+  EXPECT_EQ(error, "/ is neither an object nor an array");
+}
@@ -0,0 +1,28 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+
+#include "key_table.hpp"
+
+const std::string& KeyTable::Label(const Document::Value& member) {
+  const std::string_view raw = member.raw_key();
+  auto it = raw_index_.find(raw);
+  if (it != raw_index_.end())
+    return *it->second;
+
+  // Another spelling of a known key.
+  const std::string key = member.key();
+  const std::string* label = nullptr;
+  it = key_index_.find(key);
+  if (it != key_index_.end()) {
+    label = it->second;
+  } else {
+    label = &labels_.emplace_back("\"" + key + "\"");
+    key_index_.emplace(Key(*label), label);
+  }
+  std::string_view stored_raw = Key(*label);
+  if (key != raw)
+    stored_raw = escaped_keys_.emplace_back(raw);
+  raw_index_.emplace(stored_raw, label);
+  return *label;
+}
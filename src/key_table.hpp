@@ -0,0 +1,43 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#ifndef JSON_TUI_KEY_TABLE_HPP
+#define JSON_TUI_KEY_TABLE_HPP
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "document.hpp"
+
+// The labels of the object keys, stored once per distinct key. An array of a
+// million objects repeats the same dozen keys: the components refer to the
+// stored label instead of holding their own copy.
+class KeyTable {
+ public:
+  // The label of the key of |member|: the decoded key, between quotes. Keys
+  // are looked up by their raw text, so a repeated key is decoded only once.
+  // The spellings of a key with and without escape sequences share a label.
+  // The reference is valid as long as the table.
+  const std::string& Label(const Document::Value& member);
+
+  // The decoded key, without the quotes of its |label|.
+  static std::string_view Key(const std::string& label) {
+    return std::string_view(label).substr(1, label.size() - 2);
+  }
+
+  size_t size() const { return labels_.size(); }
+
+ private:
+  // Deques never move their elements, so the views below stay valid.
+  std::deque<std::string> labels_;
+  // The raw keys containing escape sequences. The others are viewed inside
+  // their label.
+  std::deque<std::string> escaped_keys_;
+  // By raw key, and by decoded key.
+  std::unordered_map<std::string_view, const std::string*> raw_index_;
+  std::unordered_map<std::string_view, const std::string*> key_index_;
+};
+
+#endif  // JSON_TUI_KEY_TABLE_HPP
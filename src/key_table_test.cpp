@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "document.hpp"
+#include "key_table.hpp"
+
+TEST(KeyTable, Label) {
+  Document document;
+  std::string error;
+  ASSERT_TRUE(Document::Parse(
+      R"([{"a": 1, "café": 2}, {"a": 3, "café": 4, "b": 5}, )"
+      R"({"caf\u00e9": 6}, {"caf\u00e9": 7}])",
+      document, error));
+  const Document::Value first = document.root().child(0);
+  const Document::Value second = document.root().child(1);
+
+  KeyTable keys;
+  const std::string& a = keys.Label(first.child(0));
+  const std::string& cafe = keys.Label(first.child(1));
+  EXPECT_EQ(a, "\"a\"");
+  EXPECT_EQ(cafe, "\"caf\xC3\xA9\"");
+  EXPECT_EQ(KeyTable::Key(cafe), "caf\xC3\xA9");
+
+  // Repeated keys refer to the same label.
+  EXPECT_EQ(&keys.Label(second.child(0)), &a);
+  EXPECT_EQ(&keys.Label(second.child(1)), &cafe);
+  EXPECT_EQ(keys.Label(second.child(2)), "\"b\"");
+  EXPECT_EQ(keys.size(), 3u);
+
+  // Escaped keys are looked up by their raw text too. They share the label of
+  // the same key written without escape sequences.
+  const std::string& escaped = keys.Label(document.root().child(2).child(0));
+  EXPECT_EQ(&escaped, &cafe);
+  EXPECT_EQ(&keys.Label(document.root().child(3).child(0)), &cafe);
+  EXPECT_EQ(keys.size(), 3u);
+
+  // In any order.
+  KeyTable reversed;
+  const std::string& first_escaped =
+      reversed.Label(document.root().child(2).child(0));
+  EXPECT_EQ(&reversed.Label(first.child(1)), &first_escaped);
+  EXPECT_EQ(reversed.size(), 1u);
+}
@@ -26,10 +26,23 @@ void KeyBinding() {
       {"", "q"},
       //
       {"Navigate", ""},
-      {" - first", "page-up"},
-      {" - last", "page-down"},
+      {" - page up", "page-up"},
+      {" - page down", "page-down"},
       {" - top", "gg"},
       {" - bottom", "G"},
+      {" - row N", "NG"},
+      {" - N percent", "N%"},
+      //
+      {"Search", "/"},
+      {" - next", "n"},
+      {" - previous", "N"},
+      //
+      {"Stats (--stats)", "s"},
+      //
+      {"Long string", "Enter"},
+      //
+      {"Breadcrumb (--path)", "Enter"},
+      {" - select", "←/→"},
       //
   });
   table.SelectRows(0, 0).DecorateCells(color(Color::Cyan));
@@ -37,7 +50,11 @@ void KeyBinding() {
   table.SelectRows(5, 6).Border(LIGHT);
   table.SelectRows(7, 9).Border(LIGHT);
   table.SelectRows(10, 11).Border(LIGHT);
-  table.SelectRows(12, 16).Border(LIGHT);
+  table.SelectRows(12, 18).Border(LIGHT);
+  table.SelectRows(19, 21).Border(LIGHT);
+  table.SelectRows(22, 22).Border(LIGHT);
+  table.SelectRows(23, 23).Border(LIGHT);
+  table.SelectRows(24, 25).Border(LIGHT);
   table.SelectAll().SeparatorVertical(LIGHT);
   table.SelectAll().Border(LIGHT);
   auto document = table.Render();
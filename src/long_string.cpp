@@ -0,0 +1,118 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+
+#include "long_string.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include "document.hpp"
+
+namespace {
+
+// Whether the character at |position| is escaped by a backslash.
+bool IsEscaped(std::string_view raw, size_t position) {
+  size_t backslashes = 0;
+  while (position > backslashes && raw[position - backslashes - 1] == '\\')
+    backslashes++;
+  return backslashes % 2 == 1;
+}
+
+// Whether a "\uXXXX" escape sequence starts at |position|, and encodes a high
+// surrogate.
+bool IsHighSurrogate(std::string_view raw, size_t position) {
+  if (position + 6 > raw.size() || raw[position] != '\\' ||
+      raw[position + 1] != 'u' || IsEscaped(raw, position)) {
+    return false;
+  }
+  const char c = raw[position + 2];
+  const char d = raw[position + 3];
+  return (c == 'd' || c == 'D') &&
+         (d == '8' || d == '9' || d == 'a' || d == 'A' || d == 'b' ||
+          d == 'B');
+}
+
+}  // namespace
+
+size_t StringBoundary(std::string_view raw, size_t position) {
+  if (position >= raw.size())
+    return raw.size();
+
+  // Inside the 4 hexadecimal digits of a "\uXXXX" escape sequence, or just
+  // after its 'u'.
+  for (size_t back = 1; back <= 5 && back <= position; ++back) {
+    const size_t u = position - back;
+    if (raw[u] == 'u' && IsEscaped(raw, u)) {
+      position = u + 5;
+      // The second half of a surrogate pair.
+      if (IsHighSurrogate(raw, u - 1))
+        position += 6;
+      return std::min(position, raw.size());
+    }
+  }
+
+  // After a backslash.
+  if (IsEscaped(raw, position)) {
+    if (raw[position] == 'u')
+      return StringBoundary(raw, position + 1);
+    return position + 1;
+  }
+
+  // Between the two halves of a surrogate pair.
+  if (position >= 6 && IsHighSurrogate(raw, position - 6))
+    return std::min(position + 6, raw.size());
+
+  // Inside a UTF-8 sequence.
+  while (position < raw.size() &&
+         (static_cast<uint8_t>(raw[position]) & 0xC0) == 0x80) {
+    position++;
+  }
+  return position;
+}
+
+size_t StringPageCount(std::string_view raw) {
+  return (raw.size() + kStringPageSize - 1) / kStringPageSize;
+}
+
+size_t StringPageAt(std::string_view raw, size_t position) {
+  const size_t count = StringPageCount(raw);
+  size_t page = position / kStringPageSize;
+  // The page begins after its nominal position, when it is moved to a
+  // boundary.
+  if (page > 0 && position < StringBoundary(raw, page * kStringPageSize))
+    page--;
+  return count == 0 ? 0 : std::min(page, count - 1);
+}
+
+std::string StringPage(std::string_view raw, size_t page) {
+  const size_t begin = StringBoundary(raw, page * kStringPageSize);
+  const size_t end = StringBoundary(raw, (page + 1) * kStringPageSize);
+  return Document::Unescape(raw.substr(begin, end - begin));
+}
+
+std::string StringPreview(std::string_view raw) {
+  std::string preview =
+      Document::Unescape(raw.substr(0, StringBoundary(raw, kStringPreviewSize)));
+  for (char& c : preview) {
+    if (static_cast<uint8_t>(c) < 0x20)
+      c = ' ';
+  }
+  return preview;
+}
+
+std::string FormatBytes(uint64_t bytes) {
+  const char* const kUnits[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+  double value = static_cast<double>(bytes);
+  size_t unit = 0;
+  while (value >= 1024 && unit + 1 < sizeof(kUnits) / sizeof(kUnits[0])) {
+    value /= 1024;
+    unit++;
+  }
+  char buffer[32];
+  if (unit == 0)
+    std::snprintf(buffer, sizeof(buffer), "%llu B",
+                  static_cast<unsigned long long>(bytes));
+  else
+    std::snprintf(buffer, sizeof(buffer), "%.1f %s", value, kUnits[unit]);
+  return buffer;
+}
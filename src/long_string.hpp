@@ -0,0 +1,44 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#ifndef JSON_TUI_LONG_STRING_HPP
+#define JSON_TUI_LONG_STRING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Long strings, like base64 blobs, are displayed as a short preview. Once
+// expanded, they are split into pages of about |kStringPageSize| bytes of the
+// input, and only the visible pages are decoded. The cost of displaying them
+// doesn't depend on their length.
+//
+// The functions below take the raw string: as written in the input, without
+// its quotes.
+
+// Strings longer than this are displayed as a preview.
+constexpr size_t kLongStringSize = 1024;
+constexpr size_t kStringPreviewSize = 64;
+constexpr size_t kStringPageSize = 256;
+
+// The first position at or after |position| where |raw| can be cut: outside
+// of escape sequences, surrogate pairs and UTF-8 sequences.
+size_t StringBoundary(std::string_view raw, size_t position);
+
+// The number of pages of |raw|.
+size_t StringPageCount(std::string_view raw);
+
+// The page holding the byte at |position|.
+size_t StringPageAt(std::string_view raw, size_t position);
+
+// The decoded text of the |page|-th page of |raw|.
+std::string StringPage(std::string_view raw, size_t page);
+
+// The decoded beginning of |raw|, on a single line.
+std::string StringPreview(std::string_view raw);
+
+// A size for humans, like "1.5 MiB".
+std::string FormatBytes(uint64_t bytes);
+
+#endif  // JSON_TUI_LONG_STRING_HPP
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "long_string.hpp"
+
+TEST(LongString, StringBoundary) {
+  const std::string raw = "ab\\ncd\\u00e9\\ud83d\\ude00\xC3\xA9z";
+  EXPECT_EQ(StringBoundary(raw, 0), 0u);
+  EXPECT_EQ(StringBoundary(raw, 2), 2u);
+  EXPECT_EQ(StringBoundary(raw, 3), 4u);    // After the backslash.
+  EXPECT_EQ(StringBoundary(raw, 7), 12u);   // After "\u".
+  EXPECT_EQ(StringBoundary(raw, 9), 12u);   // In the hexadecimal digits.
+  EXPECT_EQ(StringBoundary(raw, 12), 12u);
+  EXPECT_EQ(StringBoundary(raw, 14), 24u);  // In the surrogate pair.
+  EXPECT_EQ(StringBoundary(raw, 18), 24u);  // Between its halves.
+  EXPECT_EQ(StringBoundary(raw, 20), 24u);
+  EXPECT_EQ(StringBoundary(raw, 25), 26u);  // In a UTF-8 sequence.
+  EXPECT_EQ(StringBoundary(raw, 100), raw.size());
+
+  // An escaped backslash doesn't escape what follows.
+  EXPECT_EQ(StringBoundary("a\\\\u0041", 3), 3u);
+}
+
+TEST(LongString, Pages) {
+  std::string raw;
+  for (int i = 0; i < 100; ++i)
+    raw += "line " + std::to_string(i) + "\\n\\u00e9\xC3\xA9 ";
+  const size_t count = StringPageCount(raw);
+  EXPECT_EQ(count, (raw.size() + kStringPageSize - 1) / kStringPageSize);
+
+  // The pages cover the whole string, without cutting characters.
+  std::string decoded;
+  for (size_t page = 0; page < count; ++page)
+    decoded += StringPage(raw, page);
+  std::string expected;
+  for (int i = 0; i < 100; ++i)
+    expected += "line " + std::to_string(i) + "\n\xC3\xA9\xC3\xA9 ";
+  EXPECT_EQ(decoded, expected);
+
+  for (size_t position = 0; position < raw.size(); position += 7) {
+    const size_t page = StringPageAt(raw, position);
+    EXPECT_LE(StringBoundary(raw, page * kStringPageSize), position);
+    EXPECT_GT(StringBoundary(raw, (page + 1) * kStringPageSize), position);
+  }
+}
+
+TEST(LongString, Preview) {
+  EXPECT_EQ(StringPreview("a\\nb\\tc"), "a b c");
+  const std::string raw(10000, 'x');
+  EXPECT_EQ(StringPreview(raw), std::string(kStringPreviewSize, 'x'));
+}
+
+TEST(LongString, FormatBytes) {
+  EXPECT_EQ(FormatBytes(12), "12 B");
+  EXPECT_EQ(FormatBytes(1536), "1.5 KiB");
+  EXPECT_EQ(FormatBytes(50 << 20), "50.0 MiB");
+}
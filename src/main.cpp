@@ -4,16 +4,52 @@
 
 #define ARGS_NOEXCEPT
 #include <args.hxx>
+#include <cerrno>
 #include <cstdio>
-#include <fstream>
 #include <iostream>
-#include <nlohmann/json.hpp>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "document.hpp"
+#include "filter.hpp"
+#include "followed_file.hpp"
+#include "index_cache.hpp"
+#include "json_lines.hpp"
+#include "json_pointer.hpp"
 #include "keybinding.hpp"
 #include "main_ui.hpp"
+#include "mapped_file.hpp"
+#include "printer.hpp"
+#include "stats.hpp"
 #include "version.hpp"
 
-using JSON = nlohmann::json;
-bool ParseJSON(std::string input, JSON& out);
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// The arguments of a load. They are owned by the loader, which can outlive
+// main() when it is cancelled.
+struct LoadOptions {
+  std::string file;
+  // When set, the input is read from it instead of |file|.
+  FILE* input_stream = nullptr;
+  bool lines = false;
+  bool index_cache = false;
+  std::optional<std::string> pointer;
+  std::optional<Filter> filter;
+  std::shared_ptr<Stats> stats;
+};
+
+bool Load(const LoadOptions& options,
+          LoadProgress& progress,
+          LoadedDocument& out,
+          std::string& error);
+bool ReadAll(FILE* file, std::string& out, LoadProgress& progress);
+void Report(const Stats& stats, const std::string& json_file);
 
 int main(int argument_count, const char** arguments) {
   args::ArgumentParser args("");
@@ -35,6 +71,52 @@ int main(int argument_count, const char** arguments) {
       args, "fullscreen",
       "Display the JSON in fullscreen, in an alternate buffer",
       {'f', "fullscreen"});
+  args::Flag lines(args, "lines",
+                   "Read JSON Lines: one JSON value per line, as a virtual "
+                   "array",
+                   {'l', "lines"});
+  args::Flag stats_flag(args, "stats",
+                        "Display the time spent in each phase, the counts of "
+                        "nodes and components, the memory used, and the frame "
+                        "latencies. Toggle them with 's'. Printed on exit",
+                        {"stats"});
+  args::ValueFlag<std::string> stats_json(
+      args, "file", "Like --stats, and write the report to a JSON file on exit",
+      {"stats-json"});
+  args::Flag index_cache(args, "index-cache",
+                         "Keep the structural index of the file next to it, "
+                         "in <file>.json-tui-index. Reopening the file then "
+                         "skips parsing it",
+                         {"index-cache"});
+  args::ValueFlag<std::string> pointer(
+      args, "pointer",
+      "Open the UI at the value designated by a JSON pointer, like "
+      "/items/0/status. Only the containers on the way are parsed",
+      {'p', "path"});
+  args::ValueFlag<std::string> filter_expression(
+      args, "filter",
+      "Display the outputs of a jq-like filter, like '.items[] | {name, "
+      "status}', as an array. Paths, '.[]', slices, objects and "
+      "select() are supported. Only the values it visits are parsed",
+      {"filter"});
+  args::Flag follow(args, "follow",
+                    "Keep reading the file as it grows, like `tail -f`. The "
+                    "new items of a JSON Lines file or of an array are "
+                    "appended below",
+                    {"follow"});
+  args::Flag print(args, "print",
+                   "Print the tree to stdout instead of opening the UI, one "
+                   "top-level item at a time",
+                   {"print"});
+  args::ValueFlag<int> depth(
+      args, "depth",
+      "With --print, collapse the containers deeper than this. The root is "
+      "at depth 0",
+      {"depth"});
+  args::Flag color(args, "color",
+                   "With --print, use colors even when stdout is not a "
+                   "terminal",
+                   {"color"});
   bool success = args.ParseCLI(argument_count, arguments);
   if (!success) {
     std::cerr << "Invalid arguments" << std::endl;
@@ -56,48 +138,271 @@ int main(int argument_count, const char** arguments) {
     return EXIT_SUCCESS;
   }
 
-  std::stringstream ss;
-  if (file) {
-    auto file_stream = std::ifstream(args::get(file));
-    if (!file_stream) {
+  if ((pointer || filter_expression) && lines) {
+    std::cerr << "--path and --filter can't be used with --lines" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::string error;
+  if (print) {
+    if (pointer || filter_expression || follow) {
+      std::cerr << "--print can't be used with --path, --filter and --follow"
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+    FILE* input_stream = file ? fopen(args::get(file).c_str(), "rb") : stdin;
+    if (!input_stream) {
       std::cerr << "Could not open file " << args::get(file) << std::endl;
       return EXIT_FAILURE;
     }
-    ss << file_stream.rdbuf();
+    PrintOptions options;
+    options.depth = depth ? args::get(depth) : -1;
+#if defined(_WIN32)
+    options.color = color;
+#else
+    options.color = color || isatty(STDOUT_FILENO);
+#endif
+    options.lines = lines;
+    const bool printed = PrintDocument(
+        [input_stream](char* data, size_t size) {
+          return fread(data, 1, size, input_stream);
+        },
+        stdout, options, error);
+    if (file)
+      fclose(input_stream);
+    if (!printed) {
+      std::cerr << error << std::endl;
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  auto options = std::make_shared<LoadOptions>();
+  if (filter_expression) {
+    options->filter.emplace();
+    if (!Filter::Compile(args::get(filter_expression), *options->filter,
+                         error)) {
+      std::cerr << error << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (pointer)
+    options->pointer = args::get(pointer);
+  options->lines = lines;
+  options->index_cache = index_cache;
+  if (stats_flag || stats_json)
+    options->stats = std::make_shared<Stats>();
+  Stats* stats = options->stats.get();
+  const std::string stats_file = stats_json ? args::get(stats_json) : "";
+
+  if (follow) {
+    if (!file || pointer || filter_expression) {
+      std::cerr << "--follow needs a file, and can't be used with --path and "
+                   "--filter"
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::shared_ptr<FollowedFile> followed =
+        FollowedFile::Open(args::get(file));
+    if (!followed) {
+      std::cerr << "Could not open file " << args::get(file) << std::endl;
+      return EXIT_FAILURE;
+    }
+    DisplayMainUI(
+        [followed](char* data, size_t size) {
+          return followed->Read(data, size);
+        },
+        lines, /*follow=*/true, fullscreen, stats);
+    if (stats)
+      Report(*stats, stats_file);
+    return EXIT_SUCCESS;
+  }
+
+  if (file) {
+    options->file = args::get(file);
   } else {
-    std::cout << "Reading from stdin..." << std::flush;
-    ss << std::cin.rdbuf();
+    // The input is read from a copy of stdin, while the UI reads the keyboard
+    // from the terminal.
 #if defined(_WIN32)
+    options->input_stream = _fdopen(_dup(_fileno(stdin)), "rb");
     freopen("CON", "r", stdin);
 #else
+    int input_fd = dup(STDIN_FILENO);
     stdin = freopen("/dev/tty", "r", stdin);
+    // The piped input is read progressively on a background thread, and its
+    // items are displayed as they arrive. Opening it at a path, or filtering
+    // it needs the whole input first.
+    if (!pointer && !filter_expression) {
+      DisplayMainUI(
+          [input_fd](char* data, size_t size) -> size_t {
+            ssize_t bytes = 0;
+            do {
+              bytes = read(input_fd, data, size);
+            } while (bytes < 0 && errno == EINTR);
+            return bytes > 0 ? static_cast<size_t>(bytes) : 0;
+          },
+          lines, /*follow=*/false, fullscreen, stats);
+      if (stats)
+        Report(*stats, stats_file);
+      return EXIT_SUCCESS;
+    }
+    options->input_stream = fdopen(input_fd, "rb");
 #endif
+    if (!options->input_stream) {
+      std::cerr << "Could not read the standard input" << std::endl;
+      return EXIT_FAILURE;
+    }
   }
 
-  JSON json;
-  if (!ParseJSON(ss.str(), json))
+  // Everything until the first frame runs on a background thread, while the
+  // UI displays its progress.
+  const bool loaded = DisplayMainUI(
+      [options](LoadProgress& progress, LoadedDocument& out,
+                std::string& load_error) {
+        return Load(*options, progress, out, load_error);
+      },
+      fullscreen, error, stats);
+  if (!loaded && !error.empty()) {
+    std::cerr << error << std::endl;
     return EXIT_FAILURE;
-
-  DisplayMainUI(json, fullscreen);
+  }
+  // When cancelled, the loader might still be writing the stats.
+  if (loaded && stats)
+    Report(*stats, stats_file);
   return EXIT_SUCCESS;
 }
 
-bool ParseJSON(std::string input, JSON& out) {
-  class JsonParser : public nlohmann::detail::json_sax_dom_parser<
-                         JSON, nlohmann::detail::string_input_adapter_type> {
-   public:
-    JsonParser(JSON& j)
-        : nlohmann::detail::json_sax_dom_parser<
-              JSON,
-              nlohmann::detail::string_input_adapter_type>(j, false) {}
-    bool parse_error(std::size_t /*position*/,
-                     const std::string& /*last_token*/,
-                     const JSON::exception& ex) {
-      std::cerr << std::endl;
-      std::cerr << ex.what() << std::endl;
+bool Load(const LoadOptions& options,
+          LoadProgress& progress,
+          LoadedDocument& out,
+          std::string& error) {
+  Stats* stats = options.stats.get();
+
+  // The input is parsed in place: either from the file mapped in memory, or
+  // from a single buffer holding the data read from a pipe or stdin.
+  const Stats::Clock::time_point read_begin = Stats::Clock::now();
+  MappedFilePtr mapped_file;
+  if (!options.input_stream)
+    mapped_file = MappedFile::Open(options.file);
+  const MappedFile* mapped = mapped_file.get();
+  if (mapped) {
+    out.input = mapped_file->content();
+    out.input_owner = std::move(mapped_file);
+    progress.read = out.input.size();
+  } else {
+    // Not a regular file. For instance a named pipe.
+    FILE* stream = options.input_stream
+                       ? options.input_stream
+                       : fopen(options.file.c_str(), "rb");
+    if (!stream) {
+      error = "Could not open file " + options.file;
+      return false;
+    }
+    const bool read = ReadAll(stream, out.buffer, progress);
+    fclose(stream);
+    if (!read) {
+      error = options.input_stream ? "Could not read the standard input"
+                                   : "Could not read file " + options.file;
+      return false;
+    }
+    out.input = out.buffer;
+  }
+  progress.size = out.input.size();
+  if (stats)
+    stats->AddPhase("read", read_begin);
+
+  if (options.lines) {
+    const Stats::Clock::time_point index_begin = Stats::Clock::now();
+    out.lines = IndexLines(out.input);
+    if (stats)
+      stats->AddPhase("index lines", index_begin);
+    return true;
+  }
+
+  Document& document = out.document;
+  // Only files mapped in memory are cached: a pipe can't be opened twice.
+  const bool cache = options.index_cache && mapped;
+  const Stats::Clock::time_point parse_begin = Stats::Clock::now();
+  if (cache && LoadIndexCache(options.file, out.input, document)) {
+    if (stats)
+      stats->AddPhase("load index cache", parse_begin);
+  } else {
+    // Only the first pass reads the whole file. The containers are then
+    // loaded in any order.
+    if (mapped)
+      mapped->Advise(MappedFile::Access::Sequential);
+    const bool parsed = Document::ParseLazily(
+        out.input, document, error, Document::Parallelism(), &progress.parse);
+    if (mapped)
+      mapped->Advise(MappedFile::Access::Normal);
+    if (!parsed)
+      return false;
+    if (stats)
+      stats->AddPhase("parse", parse_begin);
+
+    const Stats::Clock::time_point save_begin = Stats::Clock::now();
+    // The loader runs while the UI owns the terminal: the error is printed
+    // once it exits.
+    if (cache)
+      SaveIndexCache(options.file, document, out.warning);
+    if (cache && stats)
+      stats->AddPhase("save index cache", save_begin);
+  }
+
+  if (options.filter) {
+    const Stats::Clock::time_point filter_begin = Stats::Clock::now();
+    std::string output;
+    size_t results = 0;
+    if (!options.filter->Run(document, output, results, error))
+      return false;
+    // Only the outputs are kept. The input is no longer needed.
+    Document filtered;
+    if (!Document::ParseOwned(std::move(output), filtered, error))
+      return false;
+    document = std::move(filtered);
+    if (stats) {
+      stats->AddPhase("filter", filter_begin);
+      stats->SetCount("filter outputs", results);
+    }
+  }
+
+  out.path = {{}, {document.root()}};
+  if (options.pointer) {
+    const Stats::Clock::time_point resolve_begin = Stats::Clock::now();
+    if (!ResolvePointer(document, *options.pointer, out.path, error)) {
+      error = "Invalid --path: " + error;
       return false;
     }
-  };
-  JsonParser parser(out);
-  return JSON::sax_parse(input, &parser);
+    if (stats)
+      stats->AddPhase("resolve path", resolve_begin);
+  }
+  return true;
+}
+
+// Read |file| until its end. Stop early, and fail, when the load is
+// cancelled.
+bool ReadAll(FILE* file, std::string& out, LoadProgress& progress) {
+  char chunk[1 << 16];
+  while (size_t size = fread(chunk, 1, sizeof(chunk), file)) {
+    out.append(chunk, size);
+    progress.read = out.size();
+    if (progress.parse.cancel)
+      return false;
+  }
+  return !ferror(file);
+}
+
+// Print the stats, and write them to |json_file| unless it is empty.
+void Report(const Stats& stats, const std::string& json_file) {
+  for (const std::string& line : stats.Summary())
+    std::cerr << line << std::endl;
+  if (json_file.empty())
+    return;
+  FILE* out = fopen(json_file.c_str(), "wb");
+  const std::string json = stats.ToJSON();
+  if (!out || fwrite(json.data(), 1, json.size(), out) != json.size()) {
+    std::cerr << "Could not write " << json_file << std::endl;
+  }
+  if (out)
+    fclose(out);
 }
@@ -4,25 +4,46 @@
 
 #include "main_ui.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/screen_interactive.hpp>
 #include <ftxui/dom/elements.hpp>
 #include <ftxui/dom/table.hpp>
 #include <ftxui/screen/screen.hpp>
 #include <ftxui/screen/string.hpp>
+#include <ftxui/screen/terminal.hpp>
+#include <cctype>
+#include <cstdlib>
+#include <chrono>
+#include <deque>
 #include <iostream>
-#include <nlohmann/json.hpp>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include "button.hpp"
+#include "document.hpp"
 #include "expander.hpp"
+#include "json_lines.hpp"
+#include "json_pointer.hpp"
+#include "key_table.hpp"
+#include "long_string.hpp"
 #include "mytoggle.hpp"
+#include "search_index.hpp"
+#include "stats.hpp"
+#include "stream_parser.hpp"
 
-using JSON = nlohmann::json;
+using JSON = Document::Value;
 using namespace ftxui;
 
 namespace {
 
 Component From(const JSON& json, bool is_last, int depth, Expander& expander);
 Component FromString(const JSON& json, bool is_last);
+Component FromLongString(Component prefix, const JSON& json, bool is_last);
+bool IsLongString(const JSON& json);
 Component FromNumber(const JSON& json, bool is_last);
 Component FromBoolean(const JSON& json, bool is_last);
 Component FromNull(bool is_last);
@@ -46,23 +67,77 @@ Component FromTable(Component prefix,
                     bool is_last,
                     int depth,
                     Expander& expander);
-Component FromKeyValue(const std::string& key,
+Component FromKeyValue(const std::string& label,
                        const JSON& value,
                        bool is_last,
                        int depth,
                        Expander& expander);
 Component Empty();
 Component Unimplemented();
+Component Basic(std::function<std::string()> value, Color c, bool is_last);
 Component Basic(std::string value, Color c, bool is_last);
 Component Indentation(Component child);
 Component FakeHorizontal(Component a, Component b);
 bool IsSuitableForTableView(const JSON& json);
 
+// Implemented by the components spanning several rows. Any other component of
+// the tree is a single row. Knowing the height of every node lets a frame
+// build Elements only for the rows near the viewport, instead of rendering the
+// whole tree and letting |yframe| clip it.
+//
+// Rows are logical lines: a long string wrapped by |paragraph| still counts as
+// one. The viewport keeps a margin to absorb the difference.
+class Rows {
+ public:
+  virtual ~Rows() = default;
+
+  // The number of rows of this component.
+  virtual int RowCount() = 0;
+
+  // The row holding the focus, relative to the first row of this component.
+  virtual int FocusedRow() = 0;
+
+  // Render the rows intersecting [begin, end). Rows are relative to the first
+  // row of this component.
+  virtual Element RenderRows(int begin, int end) = 0;
+
+  // Invalidate the cached row counts of this component and its descendants.
+  virtual void InvalidateRows() = 0;
+
+  // The component to focus to move the focus to |row|, clamped to the rows of
+  // this component. Rows that can't hold the focus, like closing brackets,
+  // resolve to the row above. The selection along the way is updated.
+  virtual ComponentBase* ComponentAt(int row) = 0;
+};
+
+int RowCount(ComponentBase* component);
+int FocusedRow(ComponentBase* component);
+Element RenderRows(ComponentBase* component, int begin, int end);
+void InvalidateRows(ComponentBase* component);
+ComponentBase* ComponentAt(ComponentBase* component, int row);
+void InvalidateAncestors(ComponentBase* component);
+void InvalidateRendering(ComponentBase* component);
+
+// Implemented by the components holding an object or an array, to jump to a
+// search match. Only the nodes on the way to the match are expanded.
+class Revealable {
+ public:
+  virtual ~Revealable() = default;
+
+  // Expand the nodes leading to the token at |position| in the input, and
+  // return the component displaying it.
+  virtual ComponentBase* Reveal(uint64_t position) = 0;
+};
+
+ComponentBase* Reveal(ComponentBase* component, uint64_t position);
+
 Component From(const JSON& json, bool is_last, int depth, Expander& expander) {
   if (json.is_object())
     return FromObject(Empty(), json, is_last, depth, expander);
   if (json.is_array())
     return FromArrayAny(Empty(), json, is_last, depth, expander);
+  if (IsLongString(json))
+    return FromLongString(Empty(), json, is_last);
   if (json.is_string())
     return FromString(json, is_last);
   if (json.is_number())
@@ -74,19 +149,180 @@ Component From(const JSON& json, bool is_last, int depth, Expander& expander) {
   return Unimplemented();
 }
 
+// The text of strings and numbers is read from the document when they are
+// displayed, instead of being copied into every component.
 Component FromString(const JSON& json, bool is_last) {
-  std::string value = json;
-  std::string str = "\"" + value + "\"";
-  return Basic(str, Color::GreenLight, is_last);
+  return Basic([json] { return "\"" + json.string() + "\""; },
+               Color::GreenLight, is_last);
+}
+
+bool IsLongString(const JSON& json) {
+  return json.is_string() && json.raw_string().size() > kLongStringSize;
+}
+
+// A long string is displayed as a preview. Enter expands it into pages, and
+// only the visible ones are decoded and wrapped.
+Component FromLongString(Component prefix, const JSON& json, bool is_last) {
+  class Impl : public ComponentBase, public Rows, public Revealable {
+   public:
+    Impl(Component prefix, const JSON& json, bool is_last)
+        : prefix_(prefix),
+          json_(json),
+          raw_(json.raw_string()),
+          is_last_(is_last),
+          page_count_(StringPageCount(raw_)) {}
+
+    bool OnEvent(Event event) override {
+      if (event.is_mouse()) {
+        if (!header_rendered_ ||
+            !header_box_.Contain(event.mouse().x, event.mouse().y) ||
+            !CaptureMouse(event)) {
+          return false;
+        }
+        TakeFocus();
+        selected_ = 0;
+        if (event.mouse().button == Mouse::Left &&
+            event.mouse().motion == Mouse::Pressed) {
+          SetExpanded(!expanded_);
+          return true;
+        }
+        return false;
+      }
+
+      if (event == Event::Return) {
+        SetExpanded(!expanded_);
+        return true;
+      }
+      if (!expanded_)
+        return false;
+
+      if (event == Event::ArrowDown || event == Event::Character('j')) {
+        if (selected_ >= page_count_)
+          return false;
+        selected_++;
+        return true;
+      }
+
+      if (event == Event::ArrowUp || event == Event::Character('k')) {
+        if (selected_ == 0)
+          return false;
+        selected_--;
+        return true;
+      }
+      return false;
+    }
+
+    bool Focusable() const override { return true; }
+
+    // Rows implementation. The rows are: the header line, and one row per
+    // page when expanded.
+    int RowCount() override {
+      return expanded_ ? 1 + static_cast<int>(page_count_) : 1;
+    }
+
+    int FocusedRow() override { return static_cast<int>(selected_); }
+
+    Element RenderRows(int begin, int end) override {
+      begin = std::max(begin, 0);
+      end = std::min(end, RowCount());
+      Elements elements;
+      header_rendered_ = begin == 0 && end > 0;
+      for (int row = begin; row < end; ++row)
+        elements.push_back(row == 0 ? RenderHeader() : RenderPage(row - 1));
+      return vbox(std::move(elements));
+    }
+
+    void InvalidateRows() override {}
+
+    ComponentBase* ComponentAt(int row) override {
+      selected_ = static_cast<size_t>(std::clamp(row, 0, RowCount() - 1));
+      return this;
+    }
+
+    ComponentBase* Reveal(uint64_t position) override {
+      const uint64_t raw_begin = json_.offset() + 1;
+      if (position < raw_begin) {
+        selected_ = 0;
+        return this;
+      }
+      SetExpanded(true);
+      selected_ = 1 + StringPageAt(raw_, position - raw_begin);
+      return this;
+    }
+
+   private:
+    Element OnRender() override { return RenderRows(0, RowCount()); }
+
+    void SetExpanded(bool expanded) {
+      expanded_ = expanded;
+      selected_ = 0;
+      InvalidateAncestors(this);
+    }
+
+    Element RenderHeader() {
+      Element quote =
+          text(expanded_ ? "\"" : "\"" + StringPreview(raw_) + "…\"") |
+          color(Color::GreenLight);
+      if (selected_ == 0 && Focused())
+        quote = quote | inverted | focus;
+      return hbox({
+          prefix_->Render(),
+          quote | reflect(header_box_),
+          text(" (" + FormatBytes(raw_.size()) + ")") | color(Color::GrayDark),
+          text(expanded_ || is_last_ ? "" : ","),
+      });
+    }
+
+    // The lines of the page are wrapped by the paragraphs, only for the pages
+    // on screen.
+    Element RenderPage(size_t page) {
+      std::string page_text = StringPage(raw_, page);
+      for (char& c : page_text) {
+        if (static_cast<uint8_t>(c) < 0x20 && c != '\n')
+          c = ' ';
+      }
+      Elements lines;
+      size_t line_begin = 0;
+      while (true) {
+        const size_t line_end = page_text.find('\n', line_begin);
+        lines.push_back(paragraph(page_text.substr(line_begin,
+                                                   line_end - line_begin)));
+        if (line_end == std::string::npos)
+          break;
+        line_begin = line_end + 1;
+      }
+      Element element = vbox(std::move(lines)) | color(Color::GreenLight);
+      if (selected_ == page + 1 && Focused())
+        element = element | inverted | focus;
+      if (page + 1 == page_count_) {
+        element = hbox({
+            element,
+            text(is_last_ ? "\"" : "\",") | color(Color::GreenLight),
+        });
+      }
+      return hbox({text("  "), element});
+    }
+
+    Component prefix_;
+    JSON json_;
+    std::string_view raw_;
+    bool is_last_;
+    size_t page_count_;
+    bool expanded_ = false;
+    size_t selected_ = 0;  // 0 is the header, i > 0 is the page i - 1.
+    bool header_rendered_ = false;
+    Box header_box_;
+  };
+  return Make<Impl>(prefix, json, is_last);
 }
 
 Component FromNumber(const JSON& json, bool is_last) {
-  return Basic(json.dump(), Color::CyanLight, is_last);
+  return Basic([json] { return std::string(json.lexeme()); },
+               Color::CyanLight, is_last);
 }
 
 Component FromBoolean(const JSON& json, bool is_last) {
-  bool value = json;
-  std::string str = value ? "true" : "false";
+  std::string str = json.boolean() ? "true" : "false";
   return Basic(str, Color::YellowLight, is_last);
 }
 
@@ -102,36 +338,138 @@ Component Empty() {
   return Renderer([] { return text(""); });
 }
 
-Component Basic(std::string value, Color c, bool is_last) {
-  return Renderer([value, c, is_last](bool focused) {
-    auto element = paragraph(value) | color(c);
+// Only the focus changes what a value looks like. Its element is reused until
+// then, instead of splitting the paragraph again every frame.
+Component Basic(std::function<std::string()> value, Color c, bool is_last) {
+  return Renderer([value = std::move(value), c, is_last,
+                   element = Element(),
+                   element_focused = false](bool focused) mutable {
+    if (element && focused == element_focused)
+      return element;
+    element = paragraph(value()) | color(c);
     if (focused)
       element = element | inverted | focus;
     if (!is_last)
       element = hbox({element, text(",")});
+    element_focused = focused;
     return element;
   });
 }
 
+Component Basic(std::string value, Color c, bool is_last) {
+  return Basic([value = std::move(value)] { return value; }, c, is_last);
+}
+
+// Only the types of the elements are checked, so that their members don't
+// need to be parsed.
 bool IsSuitableForTableView(const JSON& json) {
-  if (!json.is_array())
+  if (!json.is_array() || json.size() == 0)
     return false;
-  size_t columns = 0;
-  for (const auto& element : json.items()) {
-    if (!element.value().is_object())
+  for (size_t i = 0; i < json.size(); ++i) {
+    if (!json.child(i).is_object())
       return false;
-    columns = std::max(columns, element.value().size());
   }
-  return columns >= 2 || json.size() >= 2;
+  return json.size() >= 2 || json.child(0).size() >= 2;
+}
+
+int RowCount(ComponentBase* component) {
+  auto* rows = dynamic_cast<Rows*>(component);
+  return rows ? rows->RowCount() : 1;
+}
+
+int FocusedRow(ComponentBase* component) {
+  auto* rows = dynamic_cast<Rows*>(component);
+  return rows ? rows->FocusedRow() : 0;
+}
+
+Element RenderRows(ComponentBase* component, int begin, int end) {
+  if (auto* rows = dynamic_cast<Rows*>(component))
+    return rows->RenderRows(begin, end);
+  if (begin <= 0 && 0 < end)
+    return component->Render();
+  return emptyElement();
+}
+
+void InvalidateRows(ComponentBase* component) {
+  if (auto* rows = dynamic_cast<Rows*>(component))
+    rows->InvalidateRows();
+}
+
+ComponentBase* ComponentAt(ComponentBase* component, int row) {
+  auto* rows = dynamic_cast<Rows*>(component);
+  return rows ? rows->ComponentAt(row) : component;
+}
+
+ComponentBase* Reveal(ComponentBase* component, uint64_t position) {
+  auto* revealable = dynamic_cast<Revealable*>(component);
+  return revealable ? revealable->Reveal(position) : component;
+}
+
+// The labels of the keys displayed by the current UI, which its components
+// refer to. Set by a KeyScope for the lifetime of the UI. Only used on the UI
+// thread.
+KeyTable* current_keys = nullptr;
+
+KeyTable& Keys() {
+  // The components built outside of a UI, like by the benchmarks, share a
+  // table for the whole process.
+  static KeyTable process_keys;
+  return current_keys ? *current_keys : process_keys;
+}
+
+// Make Keys() return |keys| during its lifetime. It must outlive the
+// components built meanwhile.
+class KeyScope {
+ public:
+  explicit KeyScope(KeyTable& keys) : previous_(current_keys) {
+    current_keys = &keys;
+  }
+  ~KeyScope() { current_keys = previous_; }
+  KeyScope(const KeyScope&) = delete;
+  KeyScope& operator=(const KeyScope&) = delete;
+
+ private:
+  KeyTable* previous_;
+};
+
+// The focused component under |component|, or null when the focus is
+// elsewhere.
+ComponentBase* FocusedLeaf(ComponentBase* component) {
+  if (!component->Focused())
+    return nullptr;
+  while (ComponentBase* child = component->ActiveChild().get())
+    component = child;
+  return component;
 }
 
 Component Indentation(Component child) {
-  return Renderer(child, [child] {
-    return hbox({
-        text("  "),
-        child->Render(),
-    });
-  });
+  class Impl : public ComponentBase, public Rows, public Revealable {
+   public:
+    Impl(Component child) : child_(child) { Add(child); }
+
+    Element OnRender() override { return RenderRows(0, RowCount()); }
+
+    int RowCount() override { return ::RowCount(child_.get()); }
+    int FocusedRow() override { return ::FocusedRow(child_.get()); }
+    Element RenderRows(int begin, int end) override {
+      return hbox({
+          text("  "),
+          ::RenderRows(child_.get(), begin, end),
+      });
+    }
+    void InvalidateRows() override { ::InvalidateRows(child_.get()); }
+    ComponentBase* ComponentAt(int row) override {
+      return ::ComponentAt(child_.get(), row);
+    }
+
+    ComponentBase* Reveal(uint64_t position) override {
+      return ::Reveal(child_.get(), position);
+    }
+
+   private:
+    Component child_;
+  };
+  return Make<Impl>(child);
 }
 
 Component FakeHorizontal(Component a, Component b) {
@@ -146,96 +484,504 @@ Component FakeHorizontal(Component a, Component b) {
   });
 }
 
-class ComponentExpandable : public ComponentBase {
+// The children of an expanded node. There can be millions of them, like the
+// records of a large array, so a child is built only the first time it is
+// displayed or focused. The children not built yet are a single row. The
+// selection moves over all of them, like in a vertical container.
+class LazyChildren : public ComponentBase {
+ public:
+  LazyChildren(int* selected, std::function<Component(size_t)> build)
+      : selected_(*selected), build_(std::move(build)) {}
+
+  size_t size() const { return size_; }
+
+  // The children are only added at the end.
+  void Resize(size_t size) { size_ = std::max(size_, size); }
+
+  // The child at |index|, built if needed. Building it changes the rows of the
+  // ancestors.
+  ComponentBase* At(size_t index) {
+    auto it = built_.find(index);
+    if (it != built_.end())
+      return it->second.get();
+    Component child = build_(index);
+    built_[index] = child;
+    Add(child);
+    InvalidateAncestors(this);
+    return child.get();
+  }
+
+  // The children built so far, by index.
+  const std::map<size_t, Component>& built() const { return built_; }
+
+  size_t selected() const {
+    return std::min(static_cast<size_t>(std::max(selected_, 0)), size_ - 1);
+  }
+
+  bool OnEvent(Event event) override {
+    if (size_ == 0 || event.is_mouse())
+      return false;
+    if (At(selected())->OnEvent(event))
+      return true;
+
+    const int old_selected = selected_;
+    const int last = static_cast<int>(size_) - 1;
+    selected_ = static_cast<int>(selected());
+    if (event == Event::ArrowUp || event == Event::Character('k'))
+      selected_ = std::max(selected_ - 1, 0);
+    if (event == Event::ArrowDown || event == Event::Character('j'))
+      selected_ = std::min(selected_ + 1, last);
+    if (event == Event::Home)
+      selected_ = 0;
+    if (event == Event::End)
+      selected_ = last;
+    if (event == Event::Tab)
+      selected_ = selected_ >= last ? 0 : selected_ + 1;
+    if (event == Event::TabReverse)
+      selected_ = selected_ <= 0 ? last : selected_ - 1;
+    return selected_ != old_selected;
+  }
+
+  Component ActiveChild() override {
+    if (size_ == 0)
+      return nullptr;
+    At(selected());
+    return built_[selected()];
+  }
+
+  void SetActiveChild(ComponentBase* child) override {
+    for (auto& it : built_) {
+      if (it.second.get() == child)
+        selected_ = static_cast<int>(it.first);
+    }
+  }
+
+  bool Focusable() const override { return size_ != 0; }
+
+ private:
+  int& selected_;
+  std::function<Component(size_t)> build_;
+  size_t size_ = 0;
+  std::map<size_t, Component> built_;
+};
+
+class ComponentExpandable : public ComponentBase, public Rows {
  public:
   ComponentExpandable(Expander& expander) : expander_(expander->Child()) {}
 
+  // Bound to the toggle. The expander is updated when the toggle changes it.
   bool& Expanded() {
     return expander_->expanded;
   }
 
+  // Every row. The children not built yet only count as one.
+  Element OnRender() override {
+    return RenderRows(0, std::numeric_limits<int>::max());
+  }
+
   bool OnEvent(Event event) override {
-    if (ComponentBase::OnEvent(event)) {
+    Populate();
+    // The mouse changes the hovered toggles.
+    if (event.is_mouse())
+      render_dirty_ = true;
+    const bool expanded = Expanded();
+    if (event.is_mouse() ? OnMouseEvent(event) : ComponentBase::OnEvent(event)) {
+      render_dirty_ = true;
+      if (Expanded() != expanded) {
+        expander_->Update();
+        Populate();
+        InvalidateAncestors(this);
+      }
       return true;
     }
 
     if (event == Event::Character('+')) {
       expander_->Expand();
+      InvalidateRows();
+      InvalidateAncestors(this);
       return true;
     }
 
     if (event == Event::Character('-')) {
       TakeFocus();
-      return expander_->Collapse();
+      const bool collapsed = expander_->Collapse();
+      InvalidateRows();
+      InvalidateAncestors(this);
+      return collapsed;
     }
 
     return false;
   }
 
+  // Rows implementation:
+  int RowCount() override {
+    UpdateRows();
+    return rows_;
+  }
+
+  int FocusedRow() override {
+    if (!Expanded() || section_ == 0 || children_->size() == 0)
+      return 0;
+    const size_t index = children_->selected();
+    ComponentBase* child = children_->At(index);
+    UpdateRows();
+    return 1 + ChildRow(index) + ::FocusedRow(child);
+  }
+
+  // The element of the last frame is reused, unless something changed below
+  // this node: an event was handled, the rows changed, the focus moved, or
+  // other rows are visible.
+  Element RenderRows(int begin, int end) override {
+    UpdateRows();
+    begin = std::max(begin, 0);
+    // The children built by this frame can add rows, so |end| is only clamped
+    // to compare it with the last frame's.
+    const int visible_end = std::min(end, rows_);
+    ComponentBase* focused = FocusedLeaf(this);
+    if (rendered_ && !render_dirty_ && begin == rendered_rows_begin_ &&
+        visible_end == rendered_rows_end_ && focused == rendered_focused_) {
+      return rendered_;
+    }
+    render_dirty_ = false;
+    rendered_rows_begin_ = begin;
+    rendered_rows_end_ = visible_end;
+    rendered_focused_ = focused;
+
+    Elements elements;
+    header_rendered_ = begin <= 0 && 0 < end;
+    if (header_rendered_)
+      elements.push_back(header_->Render());
+
+    rendered_begin_ = rendered_end_ = 0;
+    if (Expanded()) {
+      // The rows are counted while the children are built, since a child
+      // built now can have more than one row.
+      int row = 0;
+      size_t index = ChildAtRow(std::max(begin - 1, 0), row);
+      row += 1;
+      rendered_begin_ = index;
+      for (; index < children_->size() && row < end; ++index) {
+        ComponentBase* child = children_->At(index);
+        elements.push_back(::RenderRows(child, begin - row, end - row));
+        row += ::RowCount(child);
+      }
+      rendered_end_ = index;
+      if (footer_ && index == children_->size() && begin <= row && row < end)
+        elements.push_back(footer_->Render());
+    }
+    rendered_ = vbox(std::move(elements));
+    return rendered_;
+  }
+
+  void InvalidateRows() override {
+    rows_dirty_ = true;
+    render_dirty_ = true;
+    for (auto& it : children_->built())
+      ::InvalidateRows(it.second.get());
+  }
+
+  // The footer resolves to the last row of the last child.
+  ComponentBase* ComponentAt(int row) override {
+    UpdateRows();
+    if (row <= 0 || !Expanded() || children_->size() == 0)
+      return header_.get();
+
+    int first = 0;
+    size_t index = ChildAtRow(row - 1, first);
+    if (index == children_->size()) {
+      ComponentBase* last = children_->At(index - 1);
+      return ::ComponentAt(last, ::RowCount(last) - 1);
+    }
+    return ::ComponentAt(children_->At(index), row - 1 - first);
+  }
+
+  void InvalidateOwnRows() {
+    rows_dirty_ = true;
+    render_dirty_ = true;
+  }
+
+  void InvalidateOwnRendering() { render_dirty_ = true; }
+
   Expander expander_;
+
+ protected:
+  // Layout the |header| line above the children.
+  void SetHeader(Component header) {
+    header_ = header;
+    Add(Container::Vertical(
+        {
+            header_,
+            Maybe(children_, &Expanded()),
+        },
+        &section_));
+    Populate();
+  }
+
+  // The line below the children, like a closing bracket. It can't be focused.
+  void SetFooter(Component footer) {
+    footer_ = footer;
+    InvalidateAncestors(this);
+  }
+
+  // Called the first time the node is expanded, to count its children with
+  // AddChildren(). Collapsed nodes only keep a reference to their JSON value.
+  virtual void PopulateChildren() = 0;
+
+  // Build the child at |index|, the first time it is displayed or focused. So
+  // the startup cost depends on what is visible, not on the size of the
+  // document.
+  virtual Component BuildChild(size_t index) = 0;
+
+  // Add |count| children at the end, built when they are displayed. They are
+  // a single row each until then, so the rows of this node are updated
+  // without counting them again. The cost doesn't depend on the number of
+  // children already there.
+  void AddChildren(size_t count) {
+    children_->Resize(children_->size() + count);
+    if (!rows_dirty_ && Expanded())
+      rows_ += static_cast<int>(count);
+    InvalidateAncestors(Parent());
+  }
+
+  void Populate() {
+    if (populated_ || !Expanded())
+      return;
+    populated_ = true;
+    rows_dirty_ = true;
+    render_dirty_ = true;
+    PopulateChildren();
+  }
+
+  // Expand this node, and reveal the child of |json| holding |position|.
+  // Positions before the first child are in the header.
+  ComponentBase* RevealChild(const JSON& json, uint64_t position) {
+    std::string error;
+    if (!json.Load(error) || json.size() == 0 ||
+        position < json.child(0).begin()) {
+      return header_.get();
+    }
+
+    // The last child beginning before |position|.
+    size_t low = 0;
+    size_t high = json.size();
+    while (high - low > 1) {
+      const size_t middle = (low + high) / 2;
+      if (json.child(middle).begin() <= position)
+        low = middle;
+      else
+        high = middle;
+    }
+
+    expander_->SetExpanded(true);
+    Populate();
+    InvalidateAncestors(this);
+    return ::Reveal(children_->At(low), position);
+  }
+
+  int selected_ = 0;
+  std::shared_ptr<LazyChildren> children_ = Make<LazyChildren>(
+      &selected_,
+      [this](size_t index) { return BuildChild(index); });
+
+ private:
+  // Recount the rows, only when something changed since the last frame. Only
+  // the children built so far are visited.
+  void UpdateRows() {
+    Populate();
+    if (!rows_dirty_)
+      return;
+    rows_dirty_ = false;
+    built_rows_.clear();
+    if (!Expanded()) {
+      rows_ = 1;
+      return;
+    }
+    int extra_rows = 0;
+    for (auto& it : children_->built()) {
+      const int rows = ::RowCount(it.second.get());
+      built_rows_.push_back(
+          {it.first, static_cast<int>(it.first) + extra_rows, rows});
+      extra_rows += rows - 1;
+    }
+    rows_ = 1 + static_cast<int>(children_->size()) + extra_rows +
+            (footer_ ? 1 : 0);
+  }
+
+  // The first row of the child at |index|, below the header.
+  int ChildRow(size_t index) {
+    // The last child built before |index|. |built_rows_| is sorted.
+    auto it = std::lower_bound(
+        built_rows_.begin(), built_rows_.end(), index,
+        [](const BuiltRows& built, size_t i) { return built.index < i; });
+    if (it == built_rows_.begin())
+      return static_cast<int>(index);
+    --it;
+    return it->row + it->rows + static_cast<int>(index - it->index - 1);
+  }
+
+  // The child holding |row|, counted below the header, and its first row in
+  // |first|. Past the last child, return the number of children.
+  size_t ChildAtRow(int row, int& first) {
+    // The last child built at or before |row|. |built_rows_| is sorted.
+    auto it = std::upper_bound(
+        built_rows_.begin(), built_rows_.end(), row,
+        [](int r, const BuiltRows& built) { return r < built.row; });
+    size_t index = static_cast<size_t>(row);
+    if (it != built_rows_.begin()) {
+      --it;
+      if (row < it->row + it->rows) {
+        first = it->row;
+        return it->index;
+      }
+      index = it->index + 1 + static_cast<size_t>(row - it->row - it->rows);
+    }
+    index = std::min(index, children_->size());
+    first = ChildRow(index);
+    return index;
+  }
+
+  // The components outside of the viewport were not rendered, so their boxes
+  // are stale. Mouse events are only dispatched to the rows rendered in the
+  // last frame.
+  bool OnMouseEvent(Event event) {
+    if (header_rendered_ && header_->OnEvent(event))
+      return true;
+    if (!Expanded())
+      return false;
+    const auto& built = children_->built();
+    for (auto it = built.lower_bound(rendered_begin_);
+         it != built.end() && it->first < rendered_end_; ++it) {
+      if (it->second->OnEvent(event))
+        return true;
+    }
+    return false;
+  }
+
+  bool populated_ = false;
+  int section_ = 0;
+  Component header_;
+  Component footer_;
+  bool header_rendered_ = false;
+  size_t rendered_begin_ = 0;
+  size_t rendered_end_ = 0;
+
+  bool rows_dirty_ = true;
+  int rows_ = 1;
+  // The rows of the children built, in the order of their index. The others
+  // are a single row.
+  struct BuiltRows {
+    size_t index;
+    int row;  // Below the header.
+    int rows;
+  };
+  std::vector<BuiltRows> built_rows_;
+
+  // The element of the last frame, and what it depends on.
+  Element rendered_;
+  bool render_dirty_ = true;
+  int rendered_rows_begin_ = 0;
+  int rendered_rows_end_ = 0;
+  ComponentBase* rendered_focused_ = nullptr;
 };
 
+void InvalidateAncestors(ComponentBase* component) {
+  for (; component; component = component->Parent()) {
+    if (auto* expandable = dynamic_cast<ComponentExpandable*>(component))
+      expandable->InvalidateOwnRows();
+  }
+}
+
+// Build again the elements cached by the ancestors of |component|. For
+// instance after its selection changed without an event.
+void InvalidateRendering(ComponentBase* component) {
+  for (; component; component = component->Parent()) {
+    if (auto* expandable = dynamic_cast<ComponentExpandable*>(component))
+      expandable->InvalidateOwnRendering();
+  }
+}
+
 Component FromObject(Component prefix,
                      const JSON& json,
                      bool is_last,
                      int depth,
                      Expander& expander) {
-  class Impl : public ComponentExpandable {
+  class Impl : public ComponentExpandable, public Revealable {
    public:
     Impl(Component prefix,
          const JSON& json,
          bool is_last,
          int depth,
          Expander& expander)
-        : ComponentExpandable(expander) {
-      Expanded() = (depth <= 1);
+        : ComponentExpandable(expander),
+          json_(json),
+          is_last_(is_last),
+          depth_(depth) {
+      expander_->SetExpanded(depth <= 1);
 
-      auto children = Container::Vertical({});
-      int size = static_cast<int>(json.size());
-      for (auto& it : json.items()) {
-        bool is_children_last = --size == 0;
-        children->Add(Indentation(FromKeyValue(
-            it.key(), it.value(), is_children_last, depth + 1, expander_)));
-      }
+      auto toggle = MyToggle("{", is_last ? "{...}" : "{...},", &Expanded());
+      SetHeader(FakeHorizontal(prefix, toggle));
+    }
+
+    ComponentBase* Reveal(uint64_t position) override {
+      return RevealChild(json_, position);
+    }
 
-      if (is_last)
-        children->Add(Renderer([] { return text("}"); }));
+   private:
+    void PopulateChildren() override {
+      if (!json_.Load(error_)) {
+        AddChildren(1);
+        return;
+      }
+      AddChildren(json_.size());
+      if (is_last_)
+        SetFooter(Renderer([] { return text("}"); }));
       else
-        children->Add(Renderer([] { return text("},"); }));
+        SetFooter(Renderer([] { return text("},"); }));
+    }
 
-      auto toggle = MyToggle("{", is_last ? "{...}" : "{...},", &Expanded());
-      Add(Container::Vertical({
-          FakeHorizontal(prefix, toggle),
-          Maybe(children, &Expanded()),
-      }));
+    Component BuildChild(size_t index) override {
+      if (!error_.empty())
+        return Basic(error_, Color::Red, true);
+      bool is_children_last = index + 1 == json_.size();
+      JSON child = json_.child(index);
+      return Indentation(FromKeyValue(Keys().Label(child), child,
+                                      is_children_last, depth_ + 1,
+                                      expander_));
     }
+
+    JSON json_;
+    bool is_last_;
+    int depth_;
+    std::string error_;
   };
   return Make<Impl>(prefix, json, is_last, depth, expander);
 }
 
-Component FromKeyValue(const std::string& key,
+// |label| is stored in Keys(), and shared by the members with the same key.
+Component FromKeyValue(const std::string& label,
                        const JSON& value,
                        bool is_last,
                        int depth,
                        Expander& expander) {
-  std::string str = "\"" + key + "\"";
-  if (value.is_object() || value.is_array()) {
+  const std::string* str = &label;
+  if (value.is_object() || value.is_array() || IsLongString(value)) {
     auto prefix = Renderer([str] {
       return hbox({
-          text(str) | color(Color::BlueLight),
+          text(*str) | color(Color::BlueLight),
           text(": "),
       });
     });
     if (value.is_object())
       return FromObject(prefix, value, is_last, depth, expander);
-    else
+    if (value.is_array())
       return FromArrayAny(prefix, value, is_last, depth, expander);
+    return FromLongString(prefix, value, is_last);
   }
 
   auto child = From(value, is_last, depth, expander);
   return Renderer(child, [str, child] {
     return hbox({
-        text(str) | color(Color::BlueLight),
+        text(*str) | color(Color::BlueLight),
         text(": "),
         child->Render(),
     });
@@ -247,7 +993,7 @@ Component FromArrayAny(Component prefix,
                        bool is_last,
                        int depth,
                        Expander& expander) {
-  class Impl : public ComponentBase {
+  class Impl : public ComponentBase, public Rows, public Revealable {
    public:
     Impl(Component prefix,
          const JSON& json,
@@ -256,6 +1002,21 @@ Component FromArrayAny(Component prefix,
          Expander& expander) {
       Add(FromArray(prefix, json, is_last, depth,expander));
     }
+
+    // The child is either the array or the table view. It is swapped in
+    // place, so always forward to the current one.
+    int RowCount() override { return ::RowCount(ChildAt(0).get()); }
+    int FocusedRow() override { return ::FocusedRow(ChildAt(0).get()); }
+    Element RenderRows(int begin, int end) override {
+      return ::RenderRows(ChildAt(0).get(), begin, end);
+    }
+    void InvalidateRows() override { ::InvalidateRows(ChildAt(0).get()); }
+    ComponentBase* ComponentAt(int row) override {
+      return ::ComponentAt(ChildAt(0).get(), row);
+    }
+    ComponentBase* Reveal(uint64_t position) override {
+      return ::Reveal(ChildAt(0).get(), position);
+    }
   };
 
   return Make<Impl>(prefix, json, is_last, depth, expander);
@@ -266,7 +1027,7 @@ Component FromArray(Component prefix,
                     bool is_last,
                     int depth,
                     Expander& expander) {
-  class Impl : public ComponentExpandable {
+  class Impl : public ComponentExpandable, public Revealable {
    public:
     Impl(Component prefix,
          const JSON& json,
@@ -274,73 +1035,119 @@ Component FromArray(Component prefix,
          int depth,
          Expander& expander)
         : ComponentExpandable(expander),
+          parent_expander_(expander),
           prefix_(prefix),
           json_(json),
           is_last_(is_last),
           depth_(depth) {
-      Expanded() = (depth <= 0);
-      auto children = Container::Vertical({});
-      int size = static_cast<int>(json_.size());
-      for (auto& it : json_.items()) {
-        bool is_children_last = --size == 0;
-        children->Add(Indentation(
-            From(it.value(), is_children_last, depth + 1, expander_)));
-      }
-
-      if (is_last)
-        children->Add(Renderer([] { return text("]"); }));
-      else
-        children->Add(Renderer([] { return text("],"); }));
+      expander_->SetExpanded(depth <= 0);
 
       auto toggle = MyToggle("[", is_last ? "[...]" : "[...],", &Expanded());
 
-      auto upper = Container::Horizontal({
+      upper_ = Container::Horizontal({
           FakeHorizontal(prefix_, toggle),
       });
 
-      // Turn this array into a table.
-      if (IsSuitableForTableView(json)) {
-        auto expand_button = MyButton("   ", "(table view)", [this, &expander] {
-          auto* parent = Parent();
-          auto replacement =
-              FromTable(prefix_, json_, is_last_, depth_, expander);
-          parent->DetachAllChildren();  // Detach this.
-          parent->Add(replacement);
-        });
+      // Checking whether the array fits in a table requires its elements, so
+      // unloaded arrays are checked when they are populated.
+      if (json_.loaded())
+        AddTableButton();
+
+      SetHeader(upper_);
+    }
+
+    ComponentBase* Reveal(uint64_t position) override {
+      return RevealChild(json_, position);
+    }
 
-        upper = Container::Horizontal({upper, expand_button});
+   private:
+    // Offer to turn this array into a table.
+    void AddTableButton() {
+      if (!IsSuitableForTableView(json_))
+        return;
+      auto expand_button = MyButton("   ", "(table view)", [this] {
+        auto* parent = Parent();
+        auto replacement =
+            FromTable(prefix_, json_, is_last_, depth_, parent_expander_);
+        parent->DetachAllChildren();  // Detach this.
+        parent->Add(replacement);
+        InvalidateAncestors(parent);
+      });
+      upper_->Add(expand_button);
+    }
+
+    void PopulateChildren() override {
+      const bool loaded = json_.loaded();
+      if (!json_.Load(error_)) {
+        AddChildren(1);
+        return;
       }
+      if (!loaded)
+        AddTableButton();
 
-      Add(Container::Vertical({
-          upper,
-          Maybe(children, &Expanded()),
-      }));
+      AddChildren(json_.size());
+      if (is_last_)
+        SetFooter(Renderer([] { return text("]"); }));
+      else
+        SetFooter(Renderer([] { return text("],"); }));
+    }
+
+    Component BuildChild(size_t index) override {
+      if (!error_.empty())
+        return Basic(error_, Color::Red, true);
+      bool is_children_last = index + 1 == json_.size();
+      return Indentation(
+          From(json_.child(index), is_children_last, depth_ + 1, expander_));
     }
 
+    Expander& parent_expander_;
     Component prefix_;
-    const JSON& json_;
+    Component upper_;
+    JSON json_;
     bool is_last_;
     int depth_;
+    std::string error_;
   };
   return Make<Impl>(prefix, json, is_last, depth, expander);
 }
 
+// Table view: the cell of a row without the column's key.
+constexpr uint32_t kMissingCell = std::numeric_limits<uint32_t>::max();
+constexpr int kMaxColumnWidth = 40;
+// The column widths are measured on the first rows, and on as many rows spread
+// over the array. They don't change while scrolling.
+constexpr size_t kWidthSampleRows = 64;
+// The table keeps the components of at most this number of rows, besides the
+// expanded ones.
+constexpr size_t kMaxCellRows = 1024;
+
 Component FromTable(Component prefix,
                     const JSON& json,
                     bool is_last,
                     int depth,
                     Expander& expander) {
-  class Impl : public ComponentBase {
+  // The table is virtualized: the rows are indexed into a columnar store the
+  // first time they are displayed, and only the visible rows and columns are
+  // rendered. The scalar cells are plain Elements. The objects and the arrays
+  // become components when their row is displayed or focused, so that they
+  // can be expanded in place. Switching to the table view takes constant
+  // time, whatever the size of the array.
+  class Impl : public ComponentBase, public Rows, public Revealable {
    public:
     Impl(Component prefix,
          const JSON& json,
          bool is_last,
          int depth,
          Expander& expander)
-        : prefix_(prefix), json_(json), is_last_(is_last), depth_(depth) {
-      std::vector<Component> components;
-
-      // Turn this array into a table.
+        : prefix_(prefix),
+          json_(json),
+          is_last_(is_last),
+          depth_(depth),
+          expander_(expander->Child()),
+          row_count_(json.size()),
+          indexed_(row_count_, false) {
+      expander_->SetExpanded(true);
+      // Turn this table into an array.
       expand_button_ = MyButton("", "(array view)", [this, &expander] {
         auto* parent = Parent();
         auto replacement =
@@ -348,119 +1155,1490 @@ Component FromTable(Component prefix,
         replacement->OnEvent(Event::ArrowRight);
         parent->DetachAllChildren();  // Detach this.
         parent->Add(replacement);
+        InvalidateAncestors(parent);
       });
-      components.push_back(expand_button_);
-
-      std::map<std::string, int> columns_index;
-      for (auto& row : json_.items()) {
-        children_.push_back({});
-        auto& children_row = children_.back();
-        for (auto& cell : row.value().items()) {
-          // Does it require a new column?
-          if (!columns_index.count(cell.key())) {
-            columns_index[cell.key()] = columns_.size();
-            columns_.push_back(cell.key());
-          }
+      Add(expand_button_);
+      index_width_ = static_cast<int>(std::to_string(row_count_).size());
+      MeasureColumns();
+    }
 
-          // Does the current row fits in the current column?
-          if ((int)children_row.size() <= columns_index[cell.key()]) {
-            children_row.resize(columns_index[cell.key()] + 1);
+    bool OnEvent(Event event) override {
+      if (event.is_mouse()) {
+        if (header_rendered_ && expand_button_->OnEvent(event))
+          return true;
+        // Only the rows rendered in the last frame have up to date boxes.
+        for (auto it = cells_.lower_bound(rendered_begin_);
+             it != cells_.end() && it->first < rendered_end_; ++it) {
+          for (Component& cell : it->second) {
+            if (cell && cell->OnEvent(event))
+              return true;
           }
-
-          // Fill in the data
-          auto child =
-              From(cell.value(), /*is_last=*/true, depth_ + 1, expander);
-          children_row[columns_index[cell.key()]] = child;
         }
+        return false;
       }
-      // Layout
-      for (auto& rows : children_) {
-        auto row = Container::Horizontal({});
-        for (auto& cell : rows) {
-          if (cell)
-            row->Add(cell);
-        }
-        components.push_back(row);
+
+      if (selected_ == 0 && expand_button_->OnEvent(event))
+        return true;
+
+      if (Component cell = SelectedCell(); cell && cell->OnEvent(event))
+        return true;
+
+      if (event == Event::ArrowDown || event == Event::Character('j')) {
+        if (selected_ >= row_count_)
+          return false;
+        selected_++;
+        return true;
       }
-      Add(Container::Vertical(std::move(components)));
-    }
 
-   private:
-    Element OnRender() override {
-      std::vector<std::vector<Element>> data;
-      data.push_back({text("") | color(Color::GrayDark)});
-      for (auto& title : columns_)
-        data.back().push_back(text(title));
-      int i = 0;
-      for (auto& row_children : children_) {
-        std::vector<Element> data_row;
-        data_row.push_back(text(std::to_string(i++)) | color(Color::GrayDark));
-        for (auto& child : row_children) {
-          if (child) {
-            data_row.push_back(child->Render());
-          } else {
-            data_row.push_back(text(""));
-          }
-        }
-        data.push_back(std::move(data_row));
-      }
-      auto table = Table(std::move(data));
-      table.SelectColumns(1, -1).SeparatorVertical(LIGHT);
-      table.SelectColumns(1, -1).Border(LIGHT);
-      table.SelectRectangle(1, -1, 0, 0).SeparatorVertical(HEAVY);
-      table.SelectRectangle(1, -1, 0, 0).Border(HEAVY);
-
-      return vbox({
-          hbox({
-              prefix_->Render(),
-              expand_button_->Render(),
-          }),
-          table.Render(),
-      });
-    }
+      if (event == Event::ArrowUp || event == Event::Character('k')) {
+        if (selected_ == 0)
+          return false;
+        selected_--;
+        return true;
+      }
 
-    std::vector<std::string> columns_;
-    std::vector<std::vector<Component>> children_;
+      if (event == Event::ArrowLeft || event == Event::Character('h')) {
+        if (column_ == 0)
+          return false;
+        column_--;
+        first_column_ = std::min(first_column_, column_);
+        return true;
+      }
 
-    Component prefix_;
+      if (event == Event::ArrowRight || event == Event::Character('l')) {
+        if (column_ + 1 >= columns_.size())
+          return false;
+        column_++;
+        return true;
+      }
+
+      return false;
+    }
+
+    Component ActiveChild() override {
+      return selected_ == 0 ? expand_button_ : SelectedCell();
+    }
+
+    void SetActiveChild(ComponentBase* child) override {
+      if (child == expand_button_.get()) {
+        selected_ = 0;
+        return;
+      }
+      for (auto& [row, cells] : cells_) {
+        for (size_t i = 0; i < cells.size(); ++i) {
+          if (cells[i].get() == child) {
+            selected_ = row + 1;
+            column_ = i;
+            first_column_ = std::min(first_column_, column_);
+          }
+        }
+      }
+    }
+
+    bool Focusable() const override { return true; }
+
+    // Rows implementation. The rows are: the header line, the top border, the
+    // column titles, the separator, the elements, and the bottom border. An
+    // element is a single row, unless one of its cells is expanded.
+    int RowCount() override {
+      return 5 + static_cast<int>(row_count_) + ExtraRows(row_count_);
+    }
+
+    int FocusedRow() override {
+      if (selected_ == 0)
+        return 0;
+      Component cell = SelectedCell();
+      return FirstRow(selected_ - 1) + (cell ? ::FocusedRow(cell.get()) : 0);
+    }
+
+    Element RenderRows(int begin, int end) override {
+      const int row_count = RowCount();
+      begin = std::max(begin, 0);
+      end = std::min(end, row_count);
+
+      // Index the visible elements first: they may add columns.
+      struct Visible {
+        size_t index;
+        int first;
+      };
+      std::vector<Visible> visible;
+      rendered_begin_ = rendered_end_ = 0;
+      const int data_begin = std::max(begin, 4);
+      if (row_count_ != 0 && data_begin < std::min(end, row_count - 1)) {
+        int first = 0;
+        size_t index = RowAt(data_begin, first);
+        rendered_begin_ = index;
+        for (; index < row_count_ && first < end && first < row_count - 1;
+             ++index) {
+          Cells(index);
+          visible.push_back({index, first});
+          first += RowHeight(index);
+        }
+        rendered_end_ = index;
+      }
+      UpdateVisibleColumns();
+
+      Elements elements;
+      header_rendered_ = begin == 0 && end > 0;
+      for (int row = begin; row < std::min(end, 4); ++row)
+        elements.push_back(RenderRow(row));
+      for (const Visible& row : visible) {
+        elements.push_back(
+            RenderElement(row.index, begin - row.first, end - row.first));
+      }
+      if (begin < row_count && row_count - 1 < end)
+        elements.push_back(RenderLine("└", "┴", "┘"));
+
+      Evict();
+      return vbox(std::move(elements));
+    }
+
+    void InvalidateRows() override {
+      for (auto& it : cells_) {
+        for (Component& cell : it.second) {
+          if (cell)
+            ::InvalidateRows(cell.get());
+        }
+      }
+    }
+
+    // The borders and the titles select the nearest element.
+    ComponentBase* ComponentAt(int row) override {
+      if (row <= 0 || row_count_ == 0) {
+        selected_ = 0;
+        return this;
+      }
+      int first = 0;
+      const size_t index = RowAt(std::clamp(row, 4, RowCount() - 2), first);
+      selected_ = index + 1;
+      if (Component cell = SelectedCell())
+        return ::ComponentAt(cell.get(), row - first);
+      return this;
+    }
+
+    // Select the cell holding |position|. The objects and the arrays reveal
+    // their own matches.
+    ComponentBase* Reveal(uint64_t position) override {
+      if (row_count_ == 0 || position < json_.child(0).begin()) {
+        selected_ = 0;
+        return this;
+      }
+      auto last_before = [&](const JSON& json) {
+        size_t low = 0;
+        size_t high = json.size();
+        while (high - low > 1) {
+          const size_t middle = (low + high) / 2;
+          if (json.child(middle).begin() <= position)
+            low = middle;
+          else
+            high = middle;
+        }
+        return low;
+      };
+
+      const size_t row = last_before(json_);
+      selected_ = row + 1;
+      IndexRow(row);
+      JSON object = json_.child(row);
+      if (object.size() == 0)
+        return this;
+      const uint32_t cell = static_cast<uint32_t>(last_before(object));
+      for (size_t i = 0; i < columns_.size(); ++i) {
+        if (columns_[i].cells[row] == cell) {
+          column_ = i;
+          first_column_ = std::min(first_column_, column_);
+        }
+      }
+      if (Component component = SelectedCell())
+        return ::Reveal(component.get(), position);
+      return this;
+    }
+
+   private:
+    // The cells of every row, for a given key. Each cell is the index of the
+    // member in the row object, or kMissingCell.
+    struct Column {
+      std::string_view title;  // Stored in Keys().
+      int width = 0;
+      std::vector<uint32_t> cells;
+    };
+
+    Element OnRender() override { return RenderRows(0, RowCount()); }
+
+    // Index a bounded sample of the rows, to size the columns.
+    void MeasureColumns() {
+      const size_t first_rows = std::min(row_count_, kWidthSampleRows);
+      for (size_t row = 0; row < first_rows; ++row)
+        IndexRow(row, /*measure=*/true);
+      const size_t step = std::max<size_t>(row_count_ / kWidthSampleRows, 1);
+      for (size_t row = first_rows; row < row_count_; row += step)
+        IndexRow(row, /*measure=*/true);
+    }
+
+    // When |measure| is false, only the new columns are sized.
+    void IndexRow(size_t row, bool measure = false) {
+      if (indexed_[row])
+        return;
+      indexed_[row] = true;
+      JSON object = json_.child(row);
+      for (size_t i = 0; i < object.size(); ++i) {
+        JSON cell = object.child(i);
+        const std::string& label = Keys().Label(cell);
+        auto it = column_index_.find(&label);
+        const bool created = it == column_index_.end();
+        if (created) {
+          it = column_index_.emplace(&label, columns_.size()).first;
+          const std::string_view title = KeyTable::Key(label);
+          columns_.push_back({title, string_width(std::string(title)),
+                              std::vector<uint32_t>(row_count_, kMissingCell)});
+        }
+        Column& column = columns_[it->second];
+        column.cells[row] = static_cast<uint32_t>(i);
+        if (created || measure) {
+          column.width = std::min(
+              kMaxColumnWidth,
+              std::max(column.width, string_width(CellText(cell))));
+        }
+      }
+    }
+
+    // The components of the objects and the arrays of |row|, by column. Null
+    // for the scalars.
+    std::vector<Component>& Cells(size_t row) {
+      auto it = cells_.find(row);
+      if (it != cells_.end())
+        return it->second;
+
+      IndexRow(row);
+      JSON object = json_.child(row);
+      std::vector<Component> cells;
+      for (size_t i = 0; i < columns_.size(); ++i) {
+        const uint32_t member = columns_[i].cells[row];
+        if (member == kMissingCell)
+          continue;
+        JSON value = object.child(member);
+        if (!value.is_object() && !value.is_array())
+          continue;
+        if (cells.empty())
+          cells.resize(columns_.size());
+        // The members of the row objects are two levels below the array.
+        cells[i] = From(value, /*is_last=*/true, depth_ + 2, expander_);
+        Add(cells[i]);
+      }
+      return cells_[row] = std::move(cells);
+    }
+
+    Component Cell(size_t row, size_t column) {
+      std::vector<Component>& cells = Cells(row);
+      return column < cells.size() ? cells[column] : nullptr;
+    }
+
+    Component SelectedCell() {
+      return selected_ == 0 ? nullptr : Cell(selected_ - 1, column_);
+    }
+
+    int RowHeight(size_t row) {
+      auto it = cells_.find(row);
+      return it == cells_.end() ? 1 : RowHeight(it->second);
+    }
+
+    static int RowHeight(const std::vector<Component>& cells) {
+      int height = 1;
+      for (const Component& cell : cells) {
+        if (cell)
+          height = std::max(height, ::RowCount(cell.get()));
+      }
+      return height;
+    }
+
+    // The number of rows added by the expanded cells before the element
+    // |end|.
+    int ExtraRows(size_t end) {
+      int rows = 0;
+      for (auto& it : cells_) {
+        if (it.first >= end)
+          break;
+        rows += RowHeight(it.second) - 1;
+      }
+      return rows;
+    }
+
+    int FirstRow(size_t index) {
+      return 4 + static_cast<int>(index) + ExtraRows(index);
+    }
+
+    // The element displayed at |row|, and its first row in |first|. Past the
+    // last element, return the number of elements.
+    size_t RowAt(int row, int& first) {
+      size_t index = 0;
+      first = 4;
+      for (auto& it : cells_) {
+        const int gap = static_cast<int>(it.first - index);
+        if (first + gap > row)
+          break;
+        first += gap;
+        index = it.first;
+        const int rows = RowHeight(it.second);
+        if (first + rows > row)
+          return index;
+        first += rows;
+        index++;
+      }
+      const size_t found = std::min(row_count_, index + (row - first));
+      first += static_cast<int>(found - index);
+      return found;
+    }
+
+    // Drop the components of the collapsed rows out of the viewport.
+    void Evict() {
+      if (cells_.size() <= kMaxCellRows)
+        return;
+      for (auto it = cells_.begin(); it != cells_.end();) {
+        const size_t row = it->first;
+        const bool rendered = rendered_begin_ <= row && row < rendered_end_;
+        if (rendered || row + 1 == selected_ || RowHeight(it->second) != 1) {
+          ++it;
+          continue;
+        }
+        for (Component& cell : it->second) {
+          if (cell)
+            cell->Detach();
+        }
+        it = cells_.erase(it);
+      }
+    }
+
+    // Scroll horizontally, so that the focused column is visible.
+    void UpdateVisibleColumns() {
+      const int available =
+          Terminal::Size().dimx - 2 * depth_ - index_width_ - 3;
+      auto fits = [&](size_t first, size_t last) {
+        int width = 0;
+        for (size_t i = first; i <= last; ++i)
+          width += columns_[i].width + 1;
+        return width <= available;
+      };
+      while (first_column_ < column_ && !fits(first_column_, column_))
+        first_column_++;
+
+      visible_end_ = first_column_;
+      while (visible_end_ < columns_.size() &&
+             (visible_end_ == first_column_ ||
+              fits(first_column_, visible_end_))) {
+        visible_end_++;
+      }
+    }
+
+    static std::string CellText(const JSON& json) {
+      if (IsLongString(json))
+        return "\"" + StringPreview(json.raw_string()) + "…\"";
+      if (json.is_string())
+        return "\"" + json.string() + "\"";
+      if (json.is_number())
+        return std::string(json.lexeme());
+      if (json.is_boolean())
+        return json.boolean() ? "true" : "false";
+      if (json.is_null())
+        return "null";
+      if (json.is_object())
+        return "{...}";
+      return "[...]";
+    }
+
+    static Color CellColor(const JSON& json) {
+      if (json.is_string())
+        return Color::GreenLight;
+      if (json.is_number())
+        return Color::CyanLight;
+      if (json.is_boolean())
+        return Color::YellowLight;
+      if (json.is_null())
+        return Color::RedLight;
+      return Color::GrayDark;
+    }
+
+    // A horizontal line: a border or the separator below the titles.
+    Element RenderLine(const char* left,
+                       const char* middle,
+                       const char* right) {
+      std::string line = left;
+      for (int i = 0; i < index_width_; ++i)
+        line += "─";
+      for (size_t i = first_column_; i < visible_end_; ++i) {
+        line += middle;
+        for (int j = 0; j < columns_[i].width; ++j)
+          line += "─";
+      }
+      line += visible_end_ < columns_.size() ? "─" : right;
+      return text(line);
+    }
+
+    // The rows above the elements.
+    Element RenderRow(int row) {
+      if (row == 0) {
+        return hbox({
+            prefix_->Render(),
+            expand_button_->Render(),
+        });
+      }
+      if (row == 1)
+        return RenderLine("┌", "┬", "┐");
+      if (row == 3)
+        return RenderLine("├", "┼", "┤");
+
+      Elements cells;
+      cells.push_back(text("│"));
+      cells.push_back(text("") | size(WIDTH, EQUAL, index_width_));
+      for (size_t i = first_column_; i < visible_end_; ++i) {
+        cells.push_back(text("│"));
+        cells.push_back(text(columns_[i].title) | bold |
+                        size(WIDTH, EQUAL, columns_[i].width));
+      }
+      cells.push_back(visible_end_ < columns_.size() ? text("…") : text("│"));
+      return hbox(std::move(cells));
+    }
+
+    // The rows [begin, end) of the element |index|, relative to its first row.
+    Element RenderElement(size_t index, int begin, int end) {
+      const bool selected = index + 1 == selected_;
+      const bool first_row = begin <= 0 && 0 < end;
+
+      Elements cells;
+      cells.push_back(separator());
+      cells.push_back(text(first_row ? std::to_string(index) : "") |
+                      color(Color::GrayDark) |
+                      size(WIDTH, EQUAL, index_width_));
+      JSON object = json_.child(index);
+      for (size_t i = first_column_; i < visible_end_; ++i) {
+        const Column& column = columns_[i];
+        Element cell;
+        if (Component component = Cell(index, i)) {
+          cell = ::RenderRows(component.get(), begin, end);
+        } else if (column.cells[index] == kMissingCell || !first_row) {
+          cell = text("");
+        } else {
+          JSON value = object.child(column.cells[index]);
+          cell = text(CellText(value)) | color(CellColor(value));
+          if (selected && i == column_ && Focused())
+            cell = cell | inverted | focus;
+        }
+        cells.push_back(separator());
+        cells.push_back(cell | size(WIDTH, EQUAL, column.width));
+      }
+      cells.push_back(visible_end_ < columns_.size() ? text("…")
+                                                     : separator());
+      return hbox(std::move(cells));
+    }
+
+    Component prefix_;
     Component expand_button_;
-    const JSON& json_;
+    JSON json_;
     bool is_last_;
     int depth_;
+    Expander expander_;
+
+    // The columnar store.
+    size_t row_count_;
+    std::vector<bool> indexed_;
+    std::vector<Column> columns_;
+    // Keyed by label: each key has a single one.
+    std::unordered_map<const std::string*, size_t> column_index_;
+
+    // The components of the cells, by row. See Cells().
+    std::map<size_t, std::vector<Component>> cells_;
+    size_t rendered_begin_ = 0;
+    size_t rendered_end_ = 0;
+
+    // 0 is the header line, i > 0 is the row i - 1.
+    size_t selected_ = 0;
+    size_t column_ = 0;
+    size_t first_column_ = 0;
+    size_t visible_end_ = 0;
+    int index_width_ = 1;
+    bool header_rendered_ = false;
   };
 
   return Make<Impl>(prefix, json, is_last, depth, expander);
 }
 
-}  // anonymous namespace
+// The records of a JSON Lines document, displayed as an array. There can be
+// millions of them, so a record is parsed and turned into a component only
+// when it is displayed or focused. The collapsed ones are dropped again once
+// they leave the viewport.
+class LinesRoot : public ComponentBase, public Rows, public Revealable {
+ public:
+  LinesRoot(std::string_view input,
+            std::vector<uint64_t> lines,
+            Expander& expander)
+      : input_(input), lines_(std::move(lines)), expander_(expander->Child()) {
+    expander_->SetExpanded(true);
+  }
 
-void DisplayMainUI(const JSON& json, bool fullscreen) {
-  auto screen_fullscreen = ScreenInteractive::Fullscreen();
-  auto screen_fit = ScreenInteractive::FitComponent();
-  auto& screen = fullscreen ? screen_fullscreen : screen_fit;
-  Expander expander = ExpanderImpl::Root();
-  auto component = From(json, /*is_last=*/true, /*depth=*/0, expander);
+  // Rendering every row would parse every record. Only render the ones
+  // around the focus.
+  Element OnRender() override {
+    const int focused_row = FocusedRow();
+    const int height = Terminal::Size().dimy;
+    return RenderRows(focused_row - height, focused_row + height + 1);
+  }
+
+  bool OnEvent(Event event) override {
+    if (lines_.empty())
+      return false;
+
+    if (event.is_mouse()) {
+      for (size_t i = rendered_begin_; i < rendered_end_; ++i) {
+        auto it = records_.find(i);
+        if (it != records_.end() && it->second.component->OnEvent(event))
+          return true;
+      }
+      return false;
+    }
+
+    if (Record(selected_)->OnEvent(event))
+      return true;
+
+    if (event == Event::ArrowDown || event == Event::Character('j')) {
+      if (selected_ + 1 >= lines_.size())
+        return false;
+      selected_++;
+      return true;
+    }
+
+    if (event == Event::ArrowUp || event == Event::Character('k')) {
+      if (selected_ == 0)
+        return false;
+      selected_--;
+      return true;
+    }
+
+    return false;
+  }
+
+  Component ActiveChild() override {
+    return lines_.empty() ? nullptr : Record(selected_);
+  }
+
+  void SetActiveChild(ComponentBase* child) override {
+    for (auto& it : records_) {
+      if (it.second.component.get() == child)
+        selected_ = it.first;
+    }
+  }
+
+  bool Focusable() const override { return !lines_.empty(); }
+
+  const std::vector<uint64_t>& lines() const { return lines_; }
+
+  // Rows implementation. The records not built yet are collapsed, so they are
+  // a single row. The brackets around the records take one row each.
+  int RowCount() override {
+    return 2 + static_cast<int>(lines_.size()) + ExtraRows(lines_.size());
+  }
+
+  int FocusedRow() override {
+    if (lines_.empty())
+      return 0;
+    return FirstRow(selected_) + ::FocusedRow(Record(selected_).get());
+  }
+
+  Element RenderRows(int begin, int end) override {
+    Elements elements;
+    if (begin <= 0 && 0 < end)
+      elements.push_back(text("["));
+
+    // Find the first record intersecting the viewport.
+    int row = 0;
+    size_t index = RecordAt(std::max(begin, 1), row);
+    rendered_begin_ = index;
+    for (; index < lines_.size() && row < end; ++index) {
+      Component& component = Record(index);
+      elements.push_back(
+          ::RenderRows(component.get(), begin - row, end - row));
+      row += ::RowCount(component.get());
+    }
+    rendered_end_ = index;
+
+    if (index == lines_.size() && begin <= row && row < end)
+      elements.push_back(text("]"));
+
+    Evict();
+    return vbox(std::move(elements));
+  }
+
+  void InvalidateRows() override {
+    for (auto& it : records_)
+      ::InvalidateRows(it.second.component.get());
+  }
+
+  // The brackets resolve to the first and the last record.
+  ComponentBase* ComponentAt(int row) override {
+    if (lines_.empty())
+      return this;
+    int first = 0;
+    size_t index = RecordAt(std::max(row, 1), first);
+    if (index == lines_.size()) {
+      index--;
+      first = FirstRow(index);
+      row = first + ::RowCount(Record(index).get()) - 1;
+    }
+    selected_ = index;
+    return ::ComponentAt(Record(index).get(), row - first);
+  }
+
+  ComponentBase* Reveal(uint64_t position) override {
+    if (lines_.empty())
+      return this;
+    auto it = std::upper_bound(lines_.begin(), lines_.end(), position);
+    selected_ = it == lines_.begin() ? 0 : it - lines_.begin() - 1;
+    // The records are parsed alone, their positions start at the line.
+    return ::Reveal(Record(selected_).get(), position - lines_[selected_]);
+  }
+
+ private:
+  // Keep at most this number of records besides the expanded ones.
+  static constexpr size_t kMaxRecords = 1024;
+
+  struct Entry {
+    Document document;
+    Component component;
+  };
+
+  Component& Record(size_t index) {
+    auto it = records_.find(index);
+    if (it != records_.end())
+      return it->second.component;
+
+    Entry& entry = records_[index];
+    const bool is_last = index + 1 == lines_.size();
+    std::string error;
+    Component component;
+    if (Document::ParseLazily(LineAt(input_, lines_[index]), entry.document,
+                              error)) {
+      // Collapsed, like the records not built yet.
+      component =
+          From(entry.document.root(), is_last, /*depth=*/2, expander_);
+    } else {
+      component = Basic(LocateError(index, error), Color::Red, is_last);
+    }
+    entry.component = Indentation(component);
+    Add(entry.component);
+    return entry.component;
+  }
+
+  // The record is parsed alone, so its errors are always on line 1. Report
+  // the line in the file instead.
+  std::string LocateError(size_t index, const std::string& error) {
+    const std::string prefix = "parse error at line 1";
+    if (error.compare(0, prefix.size(), prefix) != 0)
+      return error;
+    const size_t line =
+        1 + std::count(input_.begin(), input_.begin() + lines_[index], '\n');
+    return "parse error at line " + std::to_string(line) +
+           error.substr(prefix.size());
+  }
+
+  // The record displayed at |row|, and its first row in |first|. The records
+  // not built yet are a single row. Past the last record, return the number of
+  // records.
+  size_t RecordAt(int row, int& first) {
+    size_t index = 0;
+    first = 1;
+    for (auto& it : records_) {
+      const int gap = static_cast<int>(it.first - index);
+      if (first + gap > row)
+        break;
+      first += gap;
+      index = it.first;
+      const int rows = ::RowCount(it.second.component.get());
+      if (first + rows > row)
+        return index;
+      first += rows;
+      index++;
+    }
+    const size_t found = std::min(lines_.size(), index + (row - first));
+    first += static_cast<int>(found - index);
+    return found;
+  }
+
+  // The number of rows added by the expanded records before |end|.
+  int ExtraRows(size_t end) {
+    int rows = 0;
+    for (auto& it : records_) {
+      if (it.first >= end)
+        break;
+      rows += ::RowCount(it.second.component.get()) - 1;
+    }
+    return rows;
+  }
+
+  int FirstRow(size_t index) {
+    return 1 + static_cast<int>(index) + ExtraRows(index);
+  }
+
+  void Evict() {
+    if (records_.size() <= kMaxRecords)
+      return;
+    for (auto it = records_.begin(); it != records_.end();) {
+      const size_t index = it->first;
+      const bool rendered = rendered_begin_ <= index && index < rendered_end_;
+      if (rendered || index == selected_ ||
+          ::RowCount(it->second.component.get()) != 1) {
+        ++it;
+        continue;
+      }
+      it->second.component->Detach();
+      it = records_.erase(it);
+    }
+  }
+
+  std::string_view input_;
+  std::vector<uint64_t> lines_;
+  Expander expander_;
+  std::map<size_t, Entry> records_;
+  size_t selected_ = 0;
+  size_t rendered_begin_ = 0;
+  size_t rendered_end_ = 0;
+};
+
+// A container receiving its items progressively. They are appended as soon as
+// they are parsed, without rebuilding or counting the existing ones, and built
+// when they are displayed.
+class StreamContainer : public ComponentExpandable {
+ public:
+  StreamContainer(bool is_object, Expander& expander)
+      : ComponentExpandable(expander), is_object_(is_object) {
+    expander_->SetExpanded(true);
+    auto toggle = MyToggle(is_object ? "{" : "[", is_object ? "{...}" : "[...]",
+                           &Expanded());
+    SetHeader(FakeHorizontal(Empty(), toggle));
+  }
+
+  void Append(std::vector<StreamItem> items) {
+    // A deque never moves its elements, so the components can keep
+    // references to them.
+    for (StreamItem& item : items)
+      items_.push_back(std::move(item));
+    AddChildren(items.size());
+  }
+
+  void Close() {
+    if (is_object_)
+      SetFooter(Renderer([] { return text("}"); }));
+    else
+      SetFooter(Renderer([] { return text("]"); }));
+  }
+
+ private:
+  void PopulateChildren() override {}
+
+  Component BuildChild(size_t index) override {
+    const StreamItem& it = items_[index];
+    JSON value = it.value();
+    if (is_object_) {
+      return Indentation(FromKeyValue(Keys().Label(value), value, it.is_last,
+                                      /*depth=*/1, expander_));
+    }
+    return Indentation(From(value, it.is_last, /*depth=*/1, expander_));
+  }
+
+  bool is_object_;
+  std::deque<StreamItem> items_;
+};
+
+// The root of a document read progressively. A status line is displayed below
+// it until the end of the input.
+class StreamRoot : public ComponentBase, public Rows {
+ public:
+  StreamRoot(Expander& expander, std::string status)
+      : expander_(expander), status_(std::move(status)) {}
+
+  // Called on the UI thread, each time the parser made some progress.
+  void Update(StreamParser::Root root,
+              std::vector<StreamItem> items,
+              bool end,
+              const std::string& error) {
+    if (!child_) {
+      if (root == StreamParser::Root::Object ||
+          root == StreamParser::Root::Array ||
+          root == StreamParser::Root::Lines) {
+        container_ = Make<StreamContainer>(root == StreamParser::Root::Object,
+                                           expander_);
+        SetChild(container_);
+      }
+      if (root == StreamParser::Root::Value && !items.empty()) {
+        value_ = std::move(items.front());
+        SetChild(From(value_.value(), /*is_last=*/true, /*depth=*/0,
+                      expander_));
+        items.clear();
+      }
+    }
+
+    if (container_) {
+      container_->Append(std::move(items));
+      if (end && error.empty())
+        container_->Close();
+    }
+
+    if (end)
+      status_ = error;
+    error_ = !error.empty();
+  }
+
+  // Rows implementation:
+  int RowCount() override {
+    return (child_ ? ::RowCount(child_.get()) : 0) + (status_.empty() ? 0 : 1);
+  }
+
+  int FocusedRow() override {
+    return child_ ? ::FocusedRow(child_.get()) : 0;
+  }
+
+  Element RenderRows(int begin, int end) override {
+    Elements elements;
+    int rows = 0;
+    if (child_) {
+      // Rendering builds the records displayed, which adds rows.
+      elements.push_back(::RenderRows(child_.get(), begin, end));
+      rows = ::RowCount(child_.get());
+    }
+    if (!status_.empty() && begin <= rows && rows < end) {
+      elements.push_back(paragraph(status_) |
+                         color(error_ ? Color::RedLight : Color::GrayDark));
+    }
+    return vbox(std::move(elements));
+  }
+
+  void InvalidateRows() override {
+    if (child_)
+      ::InvalidateRows(child_.get());
+  }
+
+  ComponentBase* ComponentAt(int row) override {
+    if (!child_)
+      return this;
+    return ::ComponentAt(child_.get(),
+                         std::min(row, ::RowCount(child_.get()) - 1));
+  }
+
+  Element OnRender() override { return RenderRows(0, RowCount()); }
+
+ private:
+  void SetChild(Component child) {
+    child_ = child;
+    Add(child_);
+  }
+
+  Expander& expander_;
+  Component child_;
+  std::shared_ptr<StreamContainer> container_;
+  StreamItem value_;
+  std::string status_;
+  bool error_ = false;
+};
+
+// Shared between the UI and the thread reading the input. The thread stops
+// posting once the UI is closed.
+struct StreamState {
+  std::mutex mutex;
+  ScreenInteractive* screen = nullptr;
+};
+
+void ReadStream(StreamReader reader,
+                bool lines,
+                bool follow,
+                std::shared_ptr<StreamState> state,
+                StreamRoot* root) {
+  StreamParser parser(lines);
+  std::vector<char> buffer(1 << 16);
+  StreamParser::Root posted_root = StreamParser::Root::Unknown;
+  while (true) {
+    const size_t size = reader(buffer.data(), buffer.size());
+    std::vector<StreamItem> items;
+    const bool success = size ? parser.Feed({buffer.data(), size}, items)
+                              : parser.End(items);
+    // The next record might take long to come. Display this one already.
+    if (follow && size)
+      parser.Release(items);
+    const bool end = size == 0 || !success;
+    if (!items.empty() || end || parser.root() != posted_root) {
+      posted_root = parser.root();
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (!state->screen)
+        return;
+      // Tasks must be copyable, while the items are only movable.
+      auto shared_items =
+          std::make_shared<std::vector<StreamItem>>(std::move(items));
+      state->screen->Post([root, parser_root = parser.root(), shared_items,
+                           end, error = parser.error()] {
+        root->Update(parser_root, std::move(*shared_items), end, error);
+      });
+      state->screen->PostEvent(Event::Custom);
+    }
+    if (end)
+      return;
+  }
+}
+
+// Shared between the UI and the thread loading the document. The thread stops
+// posting once the UI is closed. It owns everything the load uses, so that a
+// cancelled load can finish after the UI.
+struct LoadState {
+  std::mutex mutex;
+  ScreenInteractive* screen = nullptr;
+  std::atomic<bool> done = false;
+
+  Loader loader;
+  LoadProgress progress;
+  LoadedDocument loaded;
+  std::string error;
+  bool success = false;
+};
+
+void Load(std::shared_ptr<LoadState> state) {
+  state->success = state->loader(state->progress, state->loaded, state->error);
+  std::lock_guard<std::mutex> lock(state->mutex);
+  state->done = true;
+  if (!state->screen)
+    return;
+  state->screen->Post(state->screen->ExitLoopClosure());
+  state->screen->PostEvent(Event::Custom);
+}
+
+// The progress of each step of the load, and the throughput of the last one
+// started, since the beginning.
+Element RenderLoadProgress(const LoadProgress& progress,
+                           Stats::Clock::time_point begin) {
+  const uint64_t total = progress.size;
+  auto step = [total](const char* label, uint64_t done) {
+    const float ratio =
+        total ? std::min(1.f, static_cast<float>(done) /
+                                  static_cast<float>(total))
+              : 0.f;
+    return hbox({
+        text(label) | size(WIDTH, EQUAL, 7),
+        gauge(ratio) | flex,
+        text(" " + FormatBytes(done) +
+             (total ? " / " + FormatBytes(total) : "")) |
+            size(WIDTH, EQUAL, 24),
+    });
+  };
+  const uint64_t read = progress.read;
+  const uint64_t indexed = progress.parse.indexed;
+  const uint64_t parsed = progress.parse.parsed;
+  const uint64_t done = parsed ? parsed : indexed ? indexed : read;
+  const double seconds =
+      std::chrono::duration<double>(Stats::Clock::now() - begin).count();
+  const std::string throughput =
+      seconds > 0 ? FormatBytes(static_cast<uint64_t>(done / seconds)) + "/s"
+                  : "";
+  return vbox({
+             step("read", read),
+             step("index", indexed),
+             step("parse", parsed),
+             hbox({
+                 text(std::to_string(progress.parse.nodes) + " nodes, " +
+                      throughput),
+                 filler(),
+                 text("q to cancel") | color(Color::GrayDark),
+             }),
+         }) |
+         border;
+}
+
+// The ancestors of the value opened by --path, above it. Selecting one with
+// Enter or the mouse displays it instead. Their components are built the first
+// time they are displayed.
+class Breadcrumb : public ComponentBase {
+ public:
+  Breadcrumb(std::vector<std::string> labels,
+             std::function<void(size_t)> on_select)
+      : labels_(std::move(labels)),
+        on_select_(std::move(on_select)),
+        selected_(labels_.size() - 1),
+        current_(labels_.size() - 1),
+        boxes_(labels_.size()) {}
+
+  Element OnRender() override {
+    Elements segments;
+    for (size_t i = 0; i < labels_.size(); ++i) {
+      if (i)
+        segments.push_back(text(" › ") | color(Color::GrayDark));
+      Element segment = text(labels_[i]) | reflect(boxes_[i]);
+      if (i == current_)
+        segment = segment | bold;
+      else if (i > current_)
+        segment = segment | color(Color::GrayDark);
+      if (i == selected_ && Focused())
+        segment = segment | inverted | focus;
+      segments.push_back(std::move(segment));
+    }
+    return hbox(std::move(segments));
+  }
+
+  bool OnEvent(Event event) override {
+    if (event.is_mouse()) {
+      for (size_t i = 0; i < boxes_.size(); ++i) {
+        if (!boxes_[i].Contain(event.mouse().x, event.mouse().y) ||
+            !CaptureMouse(event)) {
+          continue;
+        }
+        TakeFocus();
+        selected_ = i;
+        if (event.mouse().button == Mouse::Left &&
+            event.mouse().motion == Mouse::Pressed) {
+          on_select_(i);
+        }
+        return true;
+      }
+      return false;
+    }
+
+    if (event == Event::ArrowLeft || event == Event::Character('h')) {
+      if (selected_ == 0)
+        return false;
+      selected_--;
+      return true;
+    }
+    if (event == Event::ArrowRight || event == Event::Character('l')) {
+      if (selected_ + 1 >= labels_.size())
+        return false;
+      selected_++;
+      return true;
+    }
+    if (event == Event::Return) {
+      on_select_(selected_);
+      return true;
+    }
+    return false;
+  }
+
+  bool Focusable() const override { return true; }
+
+  void SetCurrent(size_t current) { current_ = current; }
+
+ private:
+  std::vector<std::string> labels_;
+  std::function<void(size_t)> on_select_;
+  size_t selected_;
+  size_t current_;  // The segment displayed below.
+  std::vector<Box> boxes_;
+};
+
+// The root of the UI opened at a JSON pointer: the breadcrumb on the first
+// row, then the value displayed. Search matches outside of the value display
+// the closest ancestor holding them.
+class PathRoot : public ComponentBase, public Rows, public Revealable {
+ public:
+  PathRoot(const PointerPath& path, Expander& expander)
+      : values_(path.values), levels_(values_.size()), expander_(expander) {
+    std::vector<std::string> labels = {"(root)"};
+    for (const std::string& token : path.tokens)
+      labels.push_back(token);
+    breadcrumb_ = Make<Breadcrumb>(std::move(labels),
+                                   [this](size_t level) { SetLevel(level); });
+    SetLevel(values_.size() - 1);
+    selected_ = 1;
+  }
+
+  Element OnRender() override {
+    const int focused_row = FocusedRow();
+    const int height = Terminal::Size().dimy;
+    return RenderRows(focused_row - height, focused_row + height + 1);
+  }
+
+  bool OnEvent(Event event) override {
+    if (event.is_mouse())
+      return breadcrumb_->OnEvent(event) || Level()->OnEvent(event);
+
+    if (ActiveChild()->OnEvent(event))
+      return true;
+
+    if (selected_ == 0 &&
+        (event == Event::ArrowDown || event == Event::Character('j'))) {
+      selected_ = 1;
+      return true;
+    }
+    if (selected_ == 1 &&
+        (event == Event::ArrowUp || event == Event::Character('k'))) {
+      selected_ = 0;
+      return true;
+    }
+    return false;
+  }
+
+  Component ActiveChild() override {
+    return selected_ == 0 ? breadcrumb_ : Level();
+  }
+
+  void SetActiveChild(ComponentBase* child) override {
+    selected_ = child == breadcrumb_.get() ? 0 : 1;
+  }
+
+  bool Focusable() const override { return true; }
+
+  // Rows implementation:
+  int RowCount() override { return 1 + ::RowCount(Level().get()); }
+
+  int FocusedRow() override {
+    return selected_ == 0 ? 0 : 1 + ::FocusedRow(Level().get());
+  }
+
+  Element RenderRows(int begin, int end) override {
+    Elements elements;
+    if (begin <= 0 && 0 < end)
+      elements.push_back(breadcrumb_->Render());
+    elements.push_back(::RenderRows(Level().get(), begin - 1, end - 1));
+    return vbox(std::move(elements));
+  }
+
+  void InvalidateRows() override { ::InvalidateRows(Level().get()); }
+
+  ComponentBase* ComponentAt(int row) override {
+    selected_ = row <= 0 ? 0 : 1;
+    return row <= 0 ? breadcrumb_.get() : ::ComponentAt(Level().get(), row - 1);
+  }
+
+  ComponentBase* Reveal(uint64_t position) override {
+    size_t level = level_;
+    while (level > 0 && (position < values_[level].offset() ||
+                         position >= values_[level].end())) {
+      level--;
+    }
+    SetLevel(level);
+    selected_ = 1;
+    return ::Reveal(Level().get(), position);
+  }
+
+ private:
+  Component& Level() { return levels_[level_]; }
+
+  void SetLevel(size_t level) {
+    level_ = level;
+    if (!levels_[level])
+      levels_[level] = From(values_[level], /*is_last=*/true, /*depth=*/0,
+                            expander_);
+    static_cast<Breadcrumb*>(breadcrumb_.get())->SetCurrent(level);
+    DetachAllChildren();
+    Add(breadcrumb_);
+    Add(levels_[level]);
+  }
+
+  std::vector<JSON> values_;
+  // The components of the values displayed so far, by level.
+  std::vector<Component> levels_;
+  Expander& expander_;
+  Component breadcrumb_;
+  size_t level_ = 0;
+  int selected_ = 0;  // 0 is the breadcrumb, 1 is the value.
+};
+
+// Only the rows around the focused one are rendered: one screen height on each
+// side is enough for |yframe| to center the focus, with a margin for wrapped
+// lines.
+Element RenderFrame(ComponentBase* component, int height) {
+  const int focused_row = FocusedRow(component);
+  return RenderRows(component, focused_row - height,
+                    focused_row + height + 1) |
+         yframe;
+}
+
+// The '/' prompt, and the navigation between its matches with 'n' and 'N'.
+// The index is built in the background. The queries run on the UI thread,
+// against the chunks indexed so far, and are run again as more chunks are
+// done.
+class Search {
+ public:
+  Search(ScreenInteractive& screen,
+         std::string_view input,
+         const std::vector<uint64_t>& boundaries,
+         Component root)
+      : root_(root),
+        index_(input, boundaries, [&screen] {
+          screen.PostEvent(Event::Custom);
+        }) {}
+
+  bool OnEvent(const Event& event) {
+    if (event == Event::Custom) {
+      if (indexed_chunks_ != index_.indexed_chunk_count())
+        Update();
+      return false;
+    }
+
+    if (!prompt_) {
+      if (event == Event::Character('/')) {
+        prompt_ = true;
+        query_.clear();
+        Update();
+        return true;
+      }
+      if (matches_.empty())
+        return false;
+      if (event == Event::Character('n')) {
+        Jump(current_ + 1 < matches_.size() ? current_ + 1 : 0);
+        return true;
+      }
+      if (event == Event::Character('N')) {
+        Jump(current_ > 0 ? current_ - 1 : matches_.size() - 1);
+        return true;
+      }
+      return false;
+    }
+
+    if (event == Event::Return) {
+      prompt_ = false;
+      if (!matches_.empty())
+        Jump(0);
+      return true;
+    }
+    if (event == Event::Escape) {
+      prompt_ = false;
+      query_.clear();
+      Update();
+      return true;
+    }
+    if (event == Event::Backspace) {
+      // Remove a whole UTF-8 character.
+      while (!query_.empty() && (query_.back() & 0xC0) == 0x80)
+        query_.pop_back();
+      if (!query_.empty())
+        query_.pop_back();
+      Update();
+      return true;
+    }
+    if (event.is_character()) {
+      query_ += event.character();
+      Update();
+      return true;
+    }
+    return false;
+  }
+
+  // The status line, below the document. Null when there is nothing to show.
+  Element Render() {
+    if (!prompt_ && query_.empty())
+      return nullptr;
+
+    std::string status;
+    if (matches_.empty()) {
+      status = query_.empty() ? "" : "no match";
+    } else if (prompt_) {
+      status = std::to_string(matches_.size()) +
+               (matches_.size() == kMaxMatches ? "+" : "") + " matches";
+    } else {
+      status = std::to_string(current_ + 1) + "/" +
+               std::to_string(matches_.size()) +
+               (matches_.size() == kMaxMatches ? "+" : "");
+    }
+    if (!index_.done()) {
+      status += " (indexing " +
+                std::to_string(100 * index_.indexed_chunk_count() /
+                               index_.chunk_count()) +
+                "%)";
+    }
+
+    Elements prompt = {text("/" + query_)};
+    if (prompt_)
+      prompt.push_back(text(" ") | inverted);
+    return hbox({
+        hbox(std::move(prompt)),
+        filler(),
+        text(status) | color(Color::GrayDark),
+    });
+  }
+
+ private:
+  // Displaying the count of the matches is enough, past this.
+  static constexpr size_t kMaxMatches = 100000;
+
+  void Update() {
+    indexed_chunks_ = index_.indexed_chunk_count();
+    matches_ = index_.Find(query_, kMaxMatches);
+    // Keep the current match, when more chunks are indexed.
+    auto it = std::lower_bound(matches_.begin(), matches_.end(), position_);
+    current_ = it == matches_.end() ? 0 : it - matches_.begin();
+  }
+
+  void Jump(size_t match) {
+    current_ = match;
+    position_ = matches_[match];
+    ComponentBase* target = Reveal(root_.get(), position_);
+    target->TakeFocus();
+    InvalidateRendering(target);
+  }
+
+  Component root_;
+  SearchIndex index_;
+  bool prompt_ = false;
+  std::string query_;
+  std::vector<uint64_t> matches_;
+  size_t current_ = 0;
+  uint64_t position_ = 0;
+  size_t indexed_chunks_ = 0;
+};
+
+// The number of components under |root|, including itself. The tree can be as
+// deep as the document, so it is walked without recursion.
+size_t CountComponents(ComponentBase* root) {
+  size_t count = 0;
+  std::vector<ComponentBase*> stack = {root};
+  while (!stack.empty()) {
+    ComponentBase* component = stack.back();
+    stack.pop_back();
+    count++;
+    for (size_t i = 0; i < component->ChildCount(); ++i)
+      stack.push_back(component->ChildAt(i).get());
+  }
+  return count;
+}
+
+// The --stats panel, below the document. Toggled with 's'.
+Element RenderStats(const Stats& stats) {
+  Elements lines;
+  for (const std::string& line : stats.Summary())
+    lines.push_back(text(line));
+
+  // The histogram of the latencies of the last frames.
+  const auto histogram = stats.Histogram();
+  size_t max = 1;
+  for (size_t count : histogram)
+    max = std::max(max, count);
+  Elements bars;
+  for (size_t i = 0; i < histogram.size(); ++i) {
+    const std::string label =
+        i < Stats::kBuckets.size()
+            ? "<" + std::to_string(static_cast<int>(Stats::kBuckets[i]))
+            : ">" + std::to_string(static_cast<int>(Stats::kBuckets.back()));
+    bars.push_back(vbox({
+                       gaugeUp(static_cast<float>(histogram[i]) /
+                               static_cast<float>(max)) |
+                           size(HEIGHT, EQUAL, 3),
+                       text(label),
+                   }) |
+                   size(WIDTH, EQUAL, 5));
+  }
+  lines.push_back(hbox({text("ms "), hbox(std::move(bars))}));
+  return vbox(std::move(lines)) | color(Color::GrayDark) | border;
+}
+
+// |stats| is null unless --stats is given. |counters| sets the counters
+// specific to the input, like the number of nodes.
+void Loop(ScreenInteractive& screen,
+          Component component,
+          Search* search = nullptr,
+          Stats* stats = nullptr,
+          std::function<void(Stats&)> counters = nullptr) {
+  const Stats::Clock::time_point loop_begin = Stats::Clock::now();
+  bool first_frame = true;
+  bool show_stats = true;
+  // The oldest event not displayed yet.
+  bool event_pending = false;
+  Stats::Clock::time_point event_time;
+  // Counting the components walks the whole tree. Do it at most once per
+  // second.
+  Stats::Clock::time_point counted_time;
+  auto update_counts = [&, root = component] {
+    stats->SetCount("components", CountComponents(root.get()));
+    if (counters)
+      counters(*stats);
+    counted_time = Stats::Clock::now();
+  };
+
+  // Move the focus directly to a row. The rows are counted from the cached
+  // row counts, so this doesn't depend on the size of the document.
+  Component root = component;
+  auto focus_row = [root](int row) {
+    row = std::clamp(row, 0, RowCount(root.get()) - 1);
+    ComponentBase* target = ComponentAt(root.get(), row);
+    target->TakeFocus();
+    InvalidateRendering(target);
+    return true;
+  };
 
   // Wrap it inside a frame, to allow scrolling.
-  component =
-      Renderer(component, [component] { return component->Render() | yframe; });
+  component = Renderer(component, [&, component] {
+    Element view = RenderFrame(component.get(), Terminal::Size().dimy);
+    Element status = search ? search->Render() : nullptr;
+
+    // The latency ends when the frame is rendered into elements. The layout,
+    // and the output to the terminal are not included.
+    if (stats) {
+      const Stats::Clock::time_point now = Stats::Clock::now();
+      if (first_frame)
+        stats->AddPhase("first frame", loop_begin);
+      else if (event_pending)
+        stats->AddFrameLatency(now - event_time);
+      first_frame = false;
+      event_pending = false;
+      if (show_stats && now - counted_time > std::chrono::seconds(1))
+        update_counts();
+    }
+
+    Elements elements = {view | flex};
+    if (status)
+      elements.push_back(status);
+    if (stats && show_stats)
+      elements.push_back(RenderStats(*stats));
+    if (elements.size() == 1)
+      return view;
+    return vbox(std::move(elements));
+  });
 
   Event previous_event;
   Event next_event;
+  std::string count;  // The digits typed before a command, like "50%".
   auto wrapped_component = CatchEvent(component, [&](Event event) {
+    if (stats && !event_pending && event != Event::Custom) {
+      event_pending = true;
+      event_time = Stats::Clock::now();
+    }
+
+    // Search ------------------------------------------------------------------
+    if (search && search->OnEvent(event))
+      return true;
+
+    // Posted by the background threads. Not a key.
+    if (event == Event::Custom)
+      return false;
+
     previous_event = next_event;
     next_event = event;
 
-    // 'G' and 'gg -------------------------------------------------------------
-    if (event == Event::Character('G')) {
-      while (component->OnEvent(Event::ArrowUp))
-        ;
+    // Count -------------------------------------------------------------------
+    if (event.is_character() && event.character().size() == 1 &&
+        std::isdigit(static_cast<unsigned char>(event.character()[0])) &&
+        count.size() < 9) {
+      count += event.character();
       return true;
     }
+    const int number = count.empty() ? 0 : std::atoi(count.c_str());
+    if (event != Event::Character('g'))
+      count.clear();
+
+    // 'gg', 'G', '%' and pages ------------------------------------------------
+    // With a count, 'gg' and 'G' go to that row.
     if (previous_event == Event::Character('g') &&
         next_event == Event::Character('g')) {
-      while (component->OnEvent(Event::ArrowDown))
-        ;
+      count.clear();
+      next_event = Event();
+      return focus_row(number - 1);
+    }
+    if (event == Event::Character('G'))
+      return focus_row(number ? number - 1 : RowCount(root.get()) - 1);
+    if (event == Event::Character('%') && number)
+      return focus_row(static_cast<int>(
+          (static_cast<int64_t>(RowCount(root.get())) * number + 99) / 100 -
+          1));
+
+    const int page = std::max(1, Terminal::Size().dimy - 2);
+    if (event == Event::PageUp)
+      return focus_row(FocusedRow(root.get()) - page);
+    if (event == Event::PageDown)
+      return focus_row(FocusedRow(root.get()) + page);
+
+    // Stats -------------------------------------------------------------------
+    if (stats && event == Event::Character('s')) {
+      show_stats = !show_stats;
       return true;
     }
 
@@ -485,4 +2663,167 @@ void DisplayMainUI(const JSON& json, bool fullscreen) {
   });
 
   screen.Loop(wrapped_component);
+  if (stats)
+    update_counts();
+}
+
+}  // anonymous namespace
+
+Component MakeComponent(const Document& document, Expander& expander) {
+  return From(document.root(), /*is_last=*/true, /*depth=*/0, expander);
+}
+
+void RenderFrame(Component component, Screen& screen) {
+  Render(screen, RenderFrame(component.get(), screen.dimy()));
+}
+
+void DisplayMainUI(const Document& document, bool fullscreen, Stats* stats) {
+  DisplayMainUI(document, PointerPath{{}, {document.root()}}, fullscreen,
+                stats);
+}
+
+void DisplayMainUI(const Document& document,
+                   const PointerPath& path,
+                   bool fullscreen,
+                   Stats* stats) {
+  auto screen_fullscreen = ScreenInteractive::Fullscreen();
+  auto screen_fit = ScreenInteractive::FitComponent();
+  auto& screen = fullscreen ? screen_fullscreen : screen_fit;
+  KeyTable keys;
+  KeyScope key_scope(keys);
+  Expander expander = ExpanderImpl::Root();
+  const Stats::Clock::time_point build_begin = Stats::Clock::now();
+  auto component = path.tokens.empty() ? MakeComponent(document, expander)
+                                       : Make<PathRoot>(path, expander);
+  if (stats)
+    stats->AddPhase("build", build_begin);
+  Search search(screen, document.input(),
+                document.SplitPoints(SearchIndex::kChunkSize), component);
+  Loop(screen, component, &search, stats, [&document](Stats& out) {
+    out.SetCount("nodes", document.size());
+  });
+}
+
+void DisplayMainUI(std::string_view input,
+                   std::vector<uint64_t> lines,
+                   bool fullscreen,
+                   Stats* stats) {
+  auto screen_fullscreen = ScreenInteractive::Fullscreen();
+  auto screen_fit = ScreenInteractive::FitComponent();
+  auto& screen = fullscreen ? screen_fullscreen : screen_fit;
+  KeyTable keys;
+  KeyScope key_scope(keys);
+  Expander expander = ExpanderImpl::Root();
+  const size_t records = lines.size();
+  const Stats::Clock::time_point build_begin = Stats::Clock::now();
+  auto component = Make<LinesRoot>(input, std::move(lines), expander);
+  if (stats)
+    stats->AddPhase("build", build_begin);
+  // No string spans several lines, so the index can split at any record.
+  Search search(screen, input, component->lines(), component);
+  Loop(screen, component, &search, stats,
+       [records](Stats& out) { out.SetCount("records", records); });
+}
+
+bool DisplayMainUI(Loader loader,
+                   bool fullscreen,
+                   std::string& error,
+                   Stats* stats) {
+  auto state = std::make_shared<LoadState>();
+  state->loader = std::move(loader);
+  bool cancelled = false;
+  {
+    auto screen_fullscreen = ScreenInteractive::Fullscreen();
+    auto screen_fit = ScreenInteractive::FitComponent();
+    auto& screen = fullscreen ? screen_fullscreen : screen_fit;
+    const Stats::Clock::time_point begin = Stats::Clock::now();
+    // Once loaded, the progress bar is cleared, and the document is displayed
+    // in its place.
+    auto component = Renderer([&] {
+      return state->done ? emptyElement()
+                         : RenderLoadProgress(state->progress, begin);
+    });
+    component = CatchEvent(component, [&](Event event) {
+      if (event != Event::Character('q') && event != Event::Escape)
+        return false;
+      cancelled = true;
+      state->progress.parse.cancel = true;
+      screen.ExitLoopClosure()();
+      return true;
+    });
+
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->screen = &screen;
+    }
+    std::thread loading(Load, state);
+    // The loader doesn't post anything until it is done. Redraw the progress
+    // periodically.
+    std::thread ticker([state] {
+      while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (!state->screen)
+          return;
+        state->screen->PostEvent(Event::Custom);
+      }
+    });
+
+    screen.Loop(component);
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->screen = nullptr;
+    }
+    ticker.join();
+    // A cancelled loader might be blocked reading a pipe. Let it go.
+    if (cancelled)
+      loading.detach();
+    else
+      loading.join();
+  }
+
+  if (cancelled) {
+    error.clear();
+    return false;
+  }
+  if (!state->success) {
+    error = state->error;
+    return false;
+  }
+
+  // The document parsed by the loader is displayed as is.
+  LoadedDocument& loaded = state->loaded;
+  if (loaded.lines)
+    DisplayMainUI(loaded.input, std::move(*loaded.lines), fullscreen, stats);
+  else
+    DisplayMainUI(loaded.document, loaded.path, fullscreen, stats);
+  if (!loaded.warning.empty())
+    std::cerr << loaded.warning << std::endl;
+  return true;
+}
+
+void DisplayMainUI(StreamReader reader,
+                   bool lines,
+                   bool follow,
+                   bool fullscreen,
+                   Stats* stats) {
+  auto screen_fullscreen = ScreenInteractive::Fullscreen();
+  auto screen_fit = ScreenInteractive::FitComponent();
+  auto& screen = fullscreen ? screen_fullscreen : screen_fit;
+  KeyTable keys;
+  KeyScope key_scope(keys);
+  Expander expander = ExpanderImpl::Root();
+  auto root = Make<StreamRoot>(
+      expander, follow ? "Following the file..." : "Reading from stdin...");
+
+  auto state = std::make_shared<StreamState>();
+  state->screen = &screen;
+  std::thread(ReadStream, std::move(reader), lines, follow, state, root.get())
+      .detach();
+
+  Loop(screen, root, /*search=*/nullptr, stats);
+
+  // The reader might be blocked until the producer writes again. Let it go.
+  std::lock_guard<std::mutex> lock(state->mutex);
+  state->screen = nullptr;
 }
@@ -4,8 +4,104 @@
 #ifndef JSON_TUI_MAIN_UI_HPP
 #define JSON_TUI_MAIN_UI_HPP
 
-#include <nlohmann/json.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ftxui/component/component_base.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "document.hpp"
+#include "expander.hpp"
+#include "json_pointer.hpp"
+#include "stats.hpp"
 
-void DisplayMainUI(const nlohmann::json& json, bool fullscreen);
+// When |stats| is not null, the phases and the frame latencies are recorded
+// into it, and displayed below the document.
+void DisplayMainUI(const Document& document,
+                   bool fullscreen,
+                   Stats* stats = nullptr);
+
+// Same as above, but open the UI at the last value of |path|. Its ancestors
+// are displayed in a breadcrumb above it.
+void DisplayMainUI(const Document& document,
+                   const PointerPath& path,
+                   bool fullscreen,
+                   Stats* stats = nullptr);
+
+// Display a JSON Lines document, given the position of its records. See
+// IndexLines(). The records are parsed when they are displayed.
+void DisplayMainUI(std::string_view input,
+                   std::vector<uint64_t> lines,
+                   bool fullscreen,
+                   Stats* stats = nullptr);
+
+// Read up to |size| bytes into |buffer|. Return the number of bytes read, or 0
+// at the end of the input.
+using StreamReader = std::function<size_t(char* buffer, size_t size)>;
+
+// Display the JSON document read from |reader|. It is read and parsed on a
+// background thread. The top-level items are displayed as soon as they are
+// complete, while the rest of the input is still being produced. When |lines|
+// is true, the input is read as JSON Lines. When |follow| is true, the input
+// is a file followed by |reader|, which might never end: the JSON Lines
+// records are displayed without waiting for the next one.
+void DisplayMainUI(StreamReader reader,
+                   bool lines,
+                   bool follow,
+                   bool fullscreen,
+                   Stats* stats = nullptr);
+
+// The progress of a load, published by the thread loading the document and
+// displayed by the UI.
+struct LoadProgress {
+  // The size of the input. 0 while unknown, like when reading from a pipe.
+  std::atomic<uint64_t> size = 0;
+  std::atomic<uint64_t> read = 0;
+  // The parse, and the cancellation of the whole load.
+  Document::Progress parse;
+};
+
+// What a load produces. The UI opens |document| at the last value of |path|,
+// or displays the records of |input| when |lines| is set.
+struct LoadedDocument {
+  // The input, when it isn't owned by |buffer|. For instance a mapped file.
+  std::shared_ptr<const void> input_owner;
+  std::string buffer;
+  std::string_view input;
+  std::optional<std::vector<uint64_t>> lines;
+  Document document;
+  PointerPath path;
+  // A problem not preventing the display, like an index cache that couldn't
+  // be written. The terminal belongs to the UI until it exits, so it is
+  // printed then.
+  std::string warning;
+};
+
+// Fill |out|, and report the progress into |progress|. Return false on error,
+// or when |progress.parse.cancel| is set.
+using Loader = std::function<
+    bool(LoadProgress& progress, LoadedDocument& out, std::string& error)>;
+
+// Run |loader| on a background thread, while a progress bar is displayed.
+// Pressing 'q' cancels it. The document loaded is then displayed, like above.
+// Return false when the load failed, with its |error|, or was cancelled, with
+// an empty |error|.
+bool DisplayMainUI(Loader loader,
+                   bool fullscreen,
+                   std::string& error,
+                   Stats* stats = nullptr);
+
+// The components displaying |document|, without a screen. For instance to
+// measure them.
+ftxui::Component MakeComponent(const Document& document, Expander& expander);
+
+// Render one frame of |component| to |screen|, like the UI does: only the
+// rows around the focus.
+void RenderFrame(ftxui::Component component, ftxui::Screen& screen);
 
 #endif /* json_tui_main_ui_hpp */
@@ -0,0 +1,181 @@
+#include <benchmark/benchmark.h>
+#include <ftxui/component/component_base.hpp>
+#include <ftxui/component/event.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <string>
+#include <vector>
+#include "document.hpp"
+#include "expander.hpp"
+#include "json_generator.hpp"
+#include "main_ui.hpp"
+
+using namespace ftxui;
+
+namespace {
+
+constexpr Shape kShapes[] = {Shape::Deep, Shape::Wide, Shape::Strings,
+                             Shape::Numbers, Shape::Table};
+
+// Building every component of a big document takes gigabytes, so the sizes
+// stop before the ones of the parser benchmarks.
+void Sizes(benchmark::internal::Benchmark* benchmark) {
+  for (int64_t size : {int64_t(1) << 10, int64_t(1) << 20, int64_t(64) << 20})
+    benchmark->Arg(size);
+  benchmark->Unit(benchmark::kMicrosecond);
+}
+
+void SmallSizes(benchmark::internal::Benchmark* benchmark) {
+  for (int64_t size : {int64_t(1) << 10, int64_t(1) << 20})
+    benchmark->Arg(size);
+  benchmark->Unit(benchmark::kMillisecond);
+}
+
+Screen MakeScreen() {
+  return Screen::Create(Dimension::Fixed(120), Dimension::Fixed(40));
+}
+
+bool Load(benchmark::State& state, Shape shape, Document& document) {
+  std::string error;
+  if (Document::ParseLazily(CachedJSON(shape, state.range(0)), document,
+                            error)) {
+    return true;
+  }
+  state.SkipWithError(error.c_str());
+  return false;
+}
+
+// From(): the components of the visible nodes. The others are built when
+// expanded.
+void BM_MakeComponent(benchmark::State& state, Shape shape) {
+  Document document;
+  if (!Load(state, shape, document))
+    return;
+  for (auto _ : state) {
+    Expander expander = ExpanderImpl::Root();
+    benchmark::DoNotOptimize(MakeComponent(document, expander));
+  }
+}
+
+// The first frame, including the construction of the components.
+void BM_FirstFrame(benchmark::State& state, Shape shape) {
+  Document document;
+  if (!Load(state, shape, document))
+    return;
+  Screen screen = MakeScreen();
+  for (auto _ : state) {
+    Expander expander = ExpanderImpl::Root();
+    Component component = MakeComponent(document, expander);
+    RenderFrame(component, screen);
+  }
+}
+
+// A frame after moving the focus down.
+void BM_RenderFrame(benchmark::State& state, Shape shape) {
+  Document document;
+  if (!Load(state, shape, document))
+    return;
+  Screen screen = MakeScreen();
+  Expander expander = ExpanderImpl::Root();
+  Component component = MakeComponent(document, expander);
+  RenderFrame(component, screen);
+  for (auto _ : state) {
+    component->OnEvent(Event::ArrowDown);
+    RenderFrame(component, screen);
+  }
+}
+
+// '+' until everything is expanded, then '-' until everything is collapsed,
+// with a frame after each step.
+void BM_ExpandCollapseAll(benchmark::State& state, Shape shape) {
+  Document document;
+  if (!Load(state, shape, document))
+    return;
+  Screen screen = MakeScreen();
+  Expander expander = ExpanderImpl::Root();
+  Component component = MakeComponent(document, expander);
+  RenderFrame(component, screen);
+  for (auto _ : state) {
+    int levels = 0;
+    do {
+      levels = expander->MinLevel();
+      component->OnEvent(Event::Character('+'));
+      RenderFrame(component, screen);
+    } while (expander->MinLevel() != levels);
+    while (component->OnEvent(Event::Character('-')))
+      RenderFrame(component, screen);
+  }
+}
+
+// The expander tree alone, one node per container.
+void AddExpanders(const Document::Value& value,
+                  ExpanderImpl& parent,
+                  std::vector<Expander>& out) {
+  out.push_back(parent.Child());
+  ExpanderImpl& expander = *out.back();
+  for (size_t i = 0; i < value.size(); ++i) {
+    Document::Value child = value.child(i);
+    if (child.is_object() || child.is_array())
+      AddExpanders(child, expander, out);
+  }
+}
+
+void BM_Expander(benchmark::State& state, Shape shape) {
+  Document document;
+  std::string error;
+  if (!Document::Parse(CachedJSON(shape, state.range(0)), document, error)) {
+    state.SkipWithError(error.c_str());
+    return;
+  }
+  Expander root = ExpanderImpl::Root();
+  std::vector<Expander> expanders;
+  AddExpanders(document.root(), *root, expanders);
+  for (auto _ : state) {
+    while (root->Expand())
+      ;
+    while (root->Collapse())
+      ;
+  }
+  state.counters["nodes"] = static_cast<double>(expanders.size());
+}
+
+// Switch the root array to the table view and back, with a frame after each
+// switch.
+void BM_TableSwitch(benchmark::State& state) {
+  Document document;
+  if (!Load(state, Shape::Table, document))
+    return;
+  Screen screen = MakeScreen();
+  Expander expander = ExpanderImpl::Root();
+  Component component = MakeComponent(document, expander);
+  RenderFrame(component, screen);
+  component->OnEvent(Event::ArrowRight);  // Focus the "(table view)" button.
+  for (auto _ : state) {
+    component->OnEvent(Event::Return);  // To the table view.
+    RenderFrame(component, screen);
+    component->OnEvent(Event::Return);  // Back to the array view.
+    RenderFrame(component, screen);
+  }
+}
+
+// Register |function| for every shape.
+void Register(const char* name,
+              void (*function)(benchmark::State&, Shape),
+              void (*sizes)(benchmark::internal::Benchmark*)) {
+  for (Shape shape : kShapes) {
+    const std::string full_name = std::string(name) + "/" + ShapeName(shape);
+    benchmark::RegisterBenchmark(full_name.c_str(), function, shape)
+        ->Apply(sizes);
+  }
+}
+
+const bool registered = [] {
+  Register("BM_MakeComponent", BM_MakeComponent, Sizes);
+  Register("BM_FirstFrame", BM_FirstFrame, Sizes);
+  Register("BM_RenderFrame", BM_RenderFrame, Sizes);
+  Register("BM_ExpandCollapseAll", BM_ExpandCollapseAll, SmallSizes);
+  Register("BM_Expander", BM_Expander, Sizes);
+  benchmark::RegisterBenchmark("BM_TableSwitch", BM_TableSwitch)->Apply(Sizes);
+  return true;
+}();
+
+}  // namespace
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include <ftxui/component/component_base.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <string>
+#include "document.hpp"
+#include "expander.hpp"
+#include "main_ui.hpp"
+
+using namespace ftxui;
+
+namespace {
+
+size_t CountComponents(ComponentBase* component) {
+  size_t count = 1;
+  for (size_t i = 0; i < component->ChildCount(); ++i)
+    count += CountComponents(component->ChildAt(i).get());
+  return count;
+}
+
+}  // namespace
+
+TEST(MainUI, LargeRootArray) {
+  constexpr size_t kRecords = 100000;
+  std::string input = "[";
+  for (size_t i = 0; i < kRecords; ++i) {
+    if (i)
+      input += ",\n";
+    input += R"({"id": )" + std::to_string(i) + R"(, "tags": ["a", "b"]})";
+  }
+  input += "]";
+  Document document;
+  std::string error;
+  ASSERT_TRUE(Document::ParseLazily(input, document, error)) << error;
+
+  Expander expander = ExpanderImpl::Root();
+  Component component = MakeComponent(document, expander);
+  auto screen = Screen::Create(Dimension::Fixed(80), Dimension::Fixed(24));
+  RenderFrame(component, screen);
+  EXPECT_NE(screen.ToString().find("tags"), std::string::npos);
+
+  // Only the records around the viewport are built, and loaded.
+  size_t loaded = 0;
+  for (size_t i = 0; i < kRecords; ++i)
+    loaded += document.root().child(i).loaded() ? 1 : 0;
+  EXPECT_GT(loaded, 0u);
+  EXPECT_LT(loaded, 100u);
+  EXPECT_LT(CountComponents(component.get()), 2000u);
+}
@@ -0,0 +1,107 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+
+#include "mapped_file.hpp"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+// static
+MappedFilePtr MappedFile::Open(const std::string& path) {
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return nullptr;
+
+  auto mapped = MappedFilePtr(new MappedFile());
+  mapped->file_ = file;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size))
+    return nullptr;
+  mapped->size_ = static_cast<size_t>(size.QuadPart);
+
+  // Empty files can't be mapped.
+  if (mapped->size_ == 0)
+    return mapped;
+
+  mapped->mapping_ =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapped->mapping_)
+    return nullptr;
+
+  mapped->data_ = static_cast<const char*>(
+      MapViewOfFile(mapped->mapping_, FILE_MAP_READ, 0, 0, 0));
+  if (!mapped->data_)
+    return nullptr;
+
+  return mapped;
+}
+
+MappedFile::~MappedFile() {
+  if (data_)
+    UnmapViewOfFile(data_);
+  if (mapping_)
+    CloseHandle(mapping_);
+  if (file_)
+    CloseHandle(file_);
+}
+
+void MappedFile::Advise(Access) const {}
+
+#else
+
+// static
+MappedFilePtr MappedFile::Open(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return nullptr;
+
+  struct stat stat_buffer;
+  if (fstat(fd, &stat_buffer) != 0 || !S_ISREG(stat_buffer.st_mode)) {
+    close(fd);
+    return nullptr;
+  }
+
+  auto mapped = MappedFilePtr(new MappedFile());
+  mapped->size_ = static_cast<size_t>(stat_buffer.st_size);
+
+  // Empty files can't be mapped.
+  if (mapped->size_ == 0) {
+    close(fd);
+    return mapped;
+  }
+
+  void* data = mmap(nullptr, mapped->size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // The mapping keeps its own reference to the file.
+  if (data == MAP_FAILED)
+    return nullptr;
+
+  mapped->data_ = static_cast<const char*>(data);
+  return mapped;
+}
+
+MappedFile::~MappedFile() {
+  if (data_)
+    munmap(const_cast<char*>(data_), size_);
+}
+
+void MappedFile::Advise(Access access) const {
+  if (data_) {
+    madvise(const_cast<char*>(data_), size_,
+            access == Access::Sequential ? MADV_SEQUENTIAL : MADV_NORMAL);
+  }
+}
+
+#endif
@@ -0,0 +1,49 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#ifndef JSON_TUI_MAPPED_FILE_HPP
+#define JSON_TUI_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+class MappedFile;
+using MappedFilePtr = std::unique_ptr<MappedFile>;
+
+// A read-only file mapped in memory. The pages are loaded by the OS on demand
+// and the content is never copied.
+class MappedFile {
+ public:
+  // Returns nullptr when the file can't be opened or mapped.
+  static MappedFilePtr Open(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  std::string_view content() const { return {data_, size_}; }
+
+  enum class Access {
+    Normal,
+    // Read front to back, like the first pass of the parser. The pages read
+    // can be dropped early, and the next ones are read ahead.
+    Sequential,
+  };
+  // Tell the OS how the content is about to be read. A hint, ignored where
+  // unsupported.
+  void Advise(Access access) const;
+
+ private:
+  MappedFile() = default;
+
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+#if defined(_WIN32)
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#endif
+};
+
+#endif  // JSON_TUI_MAPPED_FILE_HPP
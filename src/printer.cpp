@@ -0,0 +1,222 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+
+#include "printer.hpp"
+
+#include <string_view>
+#include <vector>
+#include "document.hpp"
+#include "long_string.hpp"
+#include "stream_parser.hpp"
+
+namespace {
+
+// The colors of the UI.
+constexpr const char* kKeyColor = "\x1B[94m";      // BlueLight.
+constexpr const char* kStringColor = "\x1B[92m";   // GreenLight.
+constexpr const char* kNumberColor = "\x1B[96m";   // CyanLight.
+constexpr const char* kBooleanColor = "\x1B[93m";  // YellowLight.
+constexpr const char* kNullColor = "\x1B[91m";     // RedLight.
+constexpr const char* kDimColor = "\x1B[90m";      // GrayDark.
+constexpr const char* kResetColor = "\x1B[39m";
+
+// The output is written by blocks of this size.
+constexpr size_t kBufferSize = 1 << 16;
+
+// The input is read by blocks of this size.
+constexpr size_t kReadSize = 1 << 20;
+
+class Printer {
+ public:
+  Printer(FILE* out, const PrintOptions& options)
+      : out_(out), options_(options) {
+    buffer_.reserve(2 * kBufferSize);
+  }
+
+  ~Printer() { Flush(); }
+
+  // Whether a container at |depth| is expanded.
+  bool Expanded(int depth) const {
+    return options_.depth < 0 || depth < options_.depth;
+  }
+
+  // Print |value| and its children, at |depth|. Deep documents are walked
+  // without recursion.
+  void Print(const Document::Value& value, int depth, bool is_last) {
+    struct Frame {
+      Document::Value value;
+      size_t next;
+      int depth;
+      bool is_last;
+    };
+    std::vector<Frame> stack;
+    auto open = [&](const Document::Value& node, int node_depth,
+                    bool node_is_last) {
+      Indent(node_depth);
+      if (node.has_key()) {
+        Colored(kKeyColor, "\"" + Printable(node.key()) + "\"");
+        Write(": ");
+      }
+      if ((node.is_object() || node.is_array()) && Expanded(node_depth)) {
+        Write(node.is_object() ? "{\n" : "[\n");
+        stack.push_back({node, 0, node_depth, node_is_last});
+        return;
+      }
+      Scalar(node, node_is_last);
+    };
+
+    open(value, depth, is_last);
+    while (!stack.empty()) {
+      Frame& frame = stack.back();
+      if (frame.next < frame.value.size()) {
+        const size_t index = frame.next++;
+        open(frame.value.child(index), frame.depth + 1,
+             index + 1 == frame.value.size());
+        continue;
+      }
+      Indent(frame.depth);
+      Close(frame.value.is_object() ? "}" : "]", frame.is_last);
+      stack.pop_back();
+    }
+  }
+
+  // A scalar, or a collapsed container.
+  void Scalar(const Document::Value& value, bool is_last) {
+    switch (value.type()) {
+      case Document::Type::Object:
+        Close("{...}", is_last);
+        return;
+      case Document::Type::Array:
+        Close("[...]", is_last);
+        return;
+      case Document::Type::String:
+        if (value.raw_string().size() > kLongStringSize) {
+          Colored(kStringColor,
+                  "\"" + Printable(StringPreview(value.raw_string())) + "…\"");
+          Colored(kDimColor,
+                  " (" + FormatBytes(value.raw_string().size()) + ")");
+        } else {
+          Colored(kStringColor, "\"" + Printable(value.string()) + "\"");
+        }
+        break;
+      case Document::Type::Number:
+        Colored(kNumberColor, value.lexeme());
+        break;
+      case Document::Type::True:
+      case Document::Type::False:
+        Colored(kBooleanColor, value.lexeme());
+        break;
+      case Document::Type::Null:
+        Colored(kNullColor, "null");
+        break;
+    }
+    Close("", is_last);
+  }
+
+  void Indent(int depth) {
+    buffer_.append(2 * static_cast<size_t>(depth), ' ');
+  }
+
+  // End the line, with a comma unless |is_last|.
+  void Close(std::string_view text, bool is_last) {
+    Write(text);
+    Write(is_last ? "\n" : ",\n");
+  }
+
+  void Write(std::string_view text) {
+    buffer_ += text;
+    if (buffer_.size() >= kBufferSize)
+      Flush();
+  }
+
+  void Colored(const char* color, std::string_view text) {
+    if (options_.color)
+      buffer_ += color;
+    buffer_ += text;
+    if (options_.color)
+      buffer_ += kResetColor;
+  }
+
+  bool Flush() {
+    if (!buffer_.empty() &&
+        fwrite(buffer_.data(), 1, buffer_.size(), out_) != buffer_.size()) {
+      failed_ = true;
+    }
+    buffer_.clear();
+    return !failed_;
+  }
+
+  bool failed() const { return failed_; }
+
+ private:
+  // The control characters would move the cursor of the terminal.
+  static std::string Printable(std::string text) {
+    for (char& c : text) {
+      if (static_cast<unsigned char>(c) < 0x20 || c == 0x7F)
+        c = ' ';
+    }
+    return text;
+  }
+
+  FILE* out_;
+  const PrintOptions& options_;
+  std::string buffer_;
+  bool failed_ = false;
+};
+
+}  // namespace
+
+bool PrintDocument(const PrintReader& reader,
+                   FILE* out,
+                   const PrintOptions& options,
+                   std::string& error) {
+  Printer printer(out, options);
+  auto write_error = [&] {
+    error = "could not write the output";
+    return false;
+  };
+  StreamParser parser(options.lines);
+  std::vector<StreamItem> items;
+  std::vector<char> chunk(kReadSize);
+  bool opened = false;
+  bool more = true;
+  while (more) {
+    const size_t size = reader(chunk.data(), chunk.size());
+    more = size > 0;
+    const bool parsed = more ? parser.Feed({chunk.data(), size}, items)
+                             : parser.End(items);
+
+    // The root's bracket is printed once known. A collapsed root is printed
+    // alone, without reading the rest.
+    const StreamParser::Root root = parser.root();
+    const bool container =
+        root == StreamParser::Root::Object ||
+        root == StreamParser::Root::Array || root == StreamParser::Root::Lines;
+    if (!opened && container) {
+      opened = true;
+      const bool object = root == StreamParser::Root::Object;
+      if (!printer.Expanded(0)) {
+        printer.Close(object ? "{...}" : "[...]", true);
+        return printer.Flush() || write_error();
+      }
+      printer.Write(object ? "{\n" : "[\n");
+    }
+
+    for (const StreamItem& item : items)
+      printer.Print(item.value(), container ? 1 : 0, item.is_last);
+    items.clear();
+
+    if (!parsed) {
+      error = parser.error();
+      printer.Flush();
+      return false;
+    }
+    if (printer.failed())
+      return write_error();
+  }
+
+  if (opened)
+    printer.Write(parser.root() == StreamParser::Root::Object ? "}\n" : "]\n");
+  return printer.Flush() || write_error();
+}
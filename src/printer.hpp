@@ -0,0 +1,37 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#ifndef JSON_TUI_PRINTER_HPP
+#define JSON_TUI_PRINTER_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+// --print: write the tree displayed by the UI as text, without a screen nor
+// components. The input is read progressively, and every top-level item is
+// printed and released as soon as it is parsed, so the memory doesn't depend
+// on the size of the input.
+struct PrintOptions {
+  // The containers deeper than this are collapsed, like "{...}". The root is
+  // at depth 0. Negative to expand everything.
+  int depth = -1;
+  // Use the colors of the UI, as ANSI escape sequences.
+  bool color = false;
+  // Read JSON Lines, displayed as an array.
+  bool lines = false;
+};
+
+// Read up to |size| bytes into |buffer|. Return the number of bytes read, or 0
+// at the end of the input.
+using PrintReader = std::function<size_t(char* buffer, size_t size)>;
+
+// Print the document read from |reader| to |out|. On failure, return false
+// and fill |error|. What was printed before the error is kept.
+bool PrintDocument(const PrintReader& reader,
+                   FILE* out,
+                   const PrintOptions& options,
+                   std::string& error);
+
+#endif  // JSON_TUI_PRINTER_HPP
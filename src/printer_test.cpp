@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include "printer.hpp"
+
+namespace {
+
+// Print |input|, fed to the printer by chunks of |chunk| bytes.
+std::string Print(std::string_view input,
+                  const PrintOptions& options,
+                  size_t chunk = 3) {
+  size_t position = 0;
+  auto reader = [&](char* buffer, size_t size) {
+    size = std::min({size, chunk, input.size() - position});
+    memcpy(buffer, input.data() + position, size);
+    position += size;
+    return size;
+  };
+  FILE* out = tmpfile();
+  std::string error;
+  EXPECT_TRUE(PrintDocument(reader, out, options, error)) << error;
+  std::string output(static_cast<size_t>(ftell(out)), '\0');
+  rewind(out);
+  EXPECT_EQ(fread(output.data(), 1, output.size(), out), output.size());
+  fclose(out);
+  return output;
+}
+
+}  // namespace
+
+TEST(Printer, Object) {
+  EXPECT_EQ(Print(R"({"a": [1, true], "b": {}, "c": "x\ny"})", {}),
+            "{\n"
+            "  \"a\": [\n"
+            "    1,\n"
+            "    true\n"
+            "  ],\n"
+            "  \"b\": {\n"
+            "  },\n"
+            "  \"c\": \"x y\"\n"
+            "}\n");
+}
+
+TEST(Printer, Depth) {
+  PrintOptions options;
+  options.depth = 1;
+  EXPECT_EQ(Print(R"([{"a": 1}, [2], null])", options),
+            "[\n"
+            "  {...},\n"
+            "  [...],\n"
+            "  null\n"
+            "]\n");
+  options.depth = 0;
+  EXPECT_EQ(Print(R"({"a": 1})", options), "{...}\n");
+}
+
+TEST(Printer, Scalar) {
+  EXPECT_EQ(Print(" 42 ", {}), "42\n");
+}
+
+TEST(Printer, Lines) {
+  PrintOptions options;
+  options.lines = true;
+  EXPECT_EQ(Print("{\"a\": 1}\n2\n", options),
+            "[\n"
+            "  {\n"
+            "    \"a\": 1\n"
+            "  },\n"
+            "  2\n"
+            "]\n");
+}
+
+TEST(Printer, Color) {
+  PrintOptions options;
+  options.color = true;
+  EXPECT_EQ(Print(R"({"a": null})", options),
+            "{\n"
+            "  \x1B[94m\"a\"\x1B[39m: \x1B[91mnull\x1B[39m\n"
+            "}\n");
+}
+
+TEST(Printer, LongString) {
+  const std::string input = "[\"" + std::string(2000, 'a') + "\"]";
+  const std::string output = Print(input, {}, 1 << 20);
+  EXPECT_NE(output.find("…\" (2.0 KiB)"), std::string::npos) << output;
+}
+
+TEST(Printer, Error) {
+  auto reader = [input = std::string_view("[1, }")](char* buffer,
+                                                    size_t size) mutable {
+    size = std::min(size, input.size());
+    memcpy(buffer, input.data(), size);
+    input.remove_prefix(size);
+    return size;
+  };
+  FILE* out = tmpfile();
+  std::string error;
+  EXPECT_FALSE(PrintDocument(reader, out, {}, error));
+  EXPECT_FALSE(error.empty());
+  fclose(out);
+}
@@ -0,0 +1,322 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+
+#include "search_index.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include "document.hpp"
+
+namespace {
+
+bool IsScalarCharacter(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+         (c >= 'A' && c <= 'Z') || c == '-' || c == '+' || c == '.';
+}
+
+// Non-ASCII bytes belong to words, so that UTF-8 text isn't split.
+bool IsWordCharacter(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+         static_cast<unsigned char>(c) >= 0x80;
+}
+
+void Lowercase(std::string& text) {
+  for (char& c : text) {
+    if (c >= 'A' && c <= 'Z')
+      c = static_cast<char>(c - 'A' + 'a');
+  }
+}
+
+// Collect the terms of a chunk, and their postings. The terms are stored once,
+// in an arena, and found by an open addressing table. This is much faster
+// than a map of strings, as there are millions of tokens per second to add.
+class TermTable {
+ public:
+  TermTable() : slots_(1 << 12, kEmpty) {}
+
+  // Index |token| as a whole, and by each of its words.
+  void Add(std::string_view token, uint32_t position) {
+    term_.assign(token);
+    Lowercase(term_);
+
+    size_t begin = 0;
+    while (begin < term_.size()) {
+      while (begin < term_.size() && !IsWordCharacter(term_[begin]))
+        begin++;
+      size_t end = begin;
+      while (end < term_.size() && IsWordCharacter(term_[end]))
+        end++;
+      if (end > begin && end - begin < term_.size())
+        Append(std::string_view(term_).substr(begin, end - begin), position);
+      begin = end;
+    }
+    Append(term_, position);
+  }
+
+  // Sort the terms, and group the postings by term.
+  void Build(std::string& text,
+             std::vector<uint32_t>& term_begin,
+             std::vector<uint32_t>& posting_begin,
+             std::vector<uint32_t>& postings) const {
+    const size_t count = hashes_.size();
+    std::vector<uint32_t> order(count);
+    for (uint32_t i = 0; i < count; ++i)
+      order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+      return Term(a) < Term(b);
+    });
+
+    std::vector<uint32_t> rank(count);
+    text.reserve(arena_.size());
+    term_begin.reserve(count + 1);
+    for (uint32_t i = 0; i < count; ++i) {
+      rank[order[i]] = i;
+      term_begin.push_back(static_cast<uint32_t>(text.size()));
+      text += Term(order[i]);
+    }
+    term_begin.push_back(static_cast<uint32_t>(text.size()));
+
+    // Counting sort. It is stable, so the postings stay sorted.
+    posting_begin.assign(count + 1, 0);
+    for (const Entry& entry : entries_)
+      posting_begin[rank[entry.term] + 1]++;
+    for (size_t i = 0; i < count; ++i)
+      posting_begin[i + 1] += posting_begin[i];
+    std::vector<uint32_t> next(posting_begin.begin(), posting_begin.end() - 1);
+    postings.resize(entries_.size());
+    for (const Entry& entry : entries_)
+      postings[next[rank[entry.term]]++] = entry.position;
+  }
+
+ private:
+  static constexpr uint32_t kEmpty = std::numeric_limits<uint32_t>::max();
+
+  struct Entry {
+    uint32_t term;
+    uint32_t position;
+  };
+
+  std::string_view Term(uint32_t id) const {
+    return std::string_view(arena_).substr(offsets_[id],
+                                           offsets_[id + 1] - offsets_[id]);
+  }
+
+  void Append(std::string_view term, uint32_t position) {
+    const uint32_t id = Find(term);
+    // A word can repeat in a token.
+    for (size_t i = entries_.size();
+         i-- > 0 && entries_[i].position == position;) {
+      if (entries_[i].term == id)
+        return;
+    }
+    entries_.push_back({id, position});
+  }
+
+  // The id of |term|. It is added if needed.
+  uint32_t Find(std::string_view term) {
+    const uint32_t hash =
+        static_cast<uint32_t>(std::hash<std::string_view>()(term));
+    const size_t mask = slots_.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+      const uint32_t id = slots_[slot];
+      if (id == kEmpty) {
+        const uint32_t added = static_cast<uint32_t>(hashes_.size());
+        slots_[slot] = added;
+        hashes_.push_back(hash);
+        if (offsets_.empty())
+          offsets_.push_back(0);
+        arena_ += term;
+        offsets_.push_back(static_cast<uint32_t>(arena_.size()));
+        if (2 * hashes_.size() > slots_.size())
+          Grow();
+        return added;
+      }
+      if (hashes_[id] == hash && Term(id) == term)
+        return id;
+    }
+  }
+
+  void Grow() {
+    std::vector<uint32_t> slots(2 * slots_.size(), kEmpty);
+    const size_t mask = slots.size() - 1;
+    for (uint32_t id = 0; id < hashes_.size(); ++id) {
+      size_t slot = hashes_[id] & mask;
+      while (slots[slot] != kEmpty)
+        slot = (slot + 1) & mask;
+      slots[slot] = id;
+    }
+    slots_ = std::move(slots);
+  }
+
+  std::vector<uint32_t> slots_;  // Term ids.
+  std::vector<uint32_t> hashes_;
+  std::string arena_;
+  std::vector<uint32_t> offsets_;  // Term id -> position in |arena_|.
+  std::vector<Entry> entries_;
+  std::string term_;  // Reused to avoid allocations.
+};
+
+}  // namespace
+
+SearchIndex::SearchIndex(std::string_view input,
+                         const std::vector<uint64_t>& boundaries,
+                         std::function<void()> on_progress)
+    : input_(input), on_progress_(std::move(on_progress)) {
+  uint64_t begin = 0;
+  for (uint64_t boundary : boundaries) {
+    if (boundary >= input.size())
+      break;
+    if (boundary < begin + kChunkSize)
+      continue;
+    auto chunk = std::make_shared<Chunk>();
+    chunk->begin = begin;
+    chunk->end = boundary;
+    chunks_.push_back(std::move(chunk));
+    begin = boundary;
+  }
+  auto chunk = std::make_shared<Chunk>();
+  chunk->begin = begin;
+  chunk->end = input.size();
+  chunks_.push_back(std::move(chunk));
+
+  // Leave a core to the UI.
+  const size_t cores = std::max(2u, std::thread::hardware_concurrency());
+  const size_t threads = std::min<size_t>(cores - 1, chunks_.size());
+  for (size_t i = 0; i < threads; ++i)
+    workers_.emplace_back(&SearchIndex::Work, this);
+}
+
+SearchIndex::~SearchIndex() {
+  stop_ = true;
+  Wait();
+}
+
+void SearchIndex::Wait() {
+  for (auto& worker : workers_)
+    worker.join();
+  workers_.clear();
+}
+
+void SearchIndex::Work() {
+  while (!stop_) {
+    const size_t index = next_chunk_++;
+    if (index >= chunks_.size())
+      return;
+
+    // Until it is published, the chunk is only known by this thread.
+    Chunk chunk;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      chunk.begin = chunks_[index]->begin;
+      chunk.end = chunks_[index]->end;
+    }
+    IndexChunk(chunk);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      chunks_[index] = std::make_shared<const Chunk>(std::move(chunk));
+    }
+    indexed_chunks_++;
+    if (on_progress_)
+      on_progress_();
+  }
+}
+
+// Tokenize the chunk. It begins outside of a string. A string beginning in the
+// chunk belongs to it, even if it ends after.
+void SearchIndex::IndexChunk(Chunk& chunk) const {
+  // The postings are 32 bits.
+  const size_t end = std::min<uint64_t>(
+      chunk.end, chunk.begin + std::numeric_limits<uint32_t>::max());
+
+  TermTable table;
+  size_t i = chunk.begin;
+  while (i < end && !stop_) {
+    const char c = input_[i];
+    if (c == '"') {
+      size_t close = i + 1;
+      bool escaped = false;
+      while (close < input_.size() && input_[close] != '"') {
+        if (input_[close] == '\\') {
+          escaped = true;
+          close++;
+        }
+        close++;
+      }
+      const uint32_t position = static_cast<uint32_t>(i - chunk.begin);
+      if (close < input_.size()) {
+        std::string_view raw = input_.substr(i + 1, close - i - 1);
+        if (escaped)
+          table.Add(Document::Unescape(raw), position);
+        else
+          table.Add(raw, position);
+      }
+      i = close + 1;
+      continue;
+    }
+
+    if (IsScalarCharacter(c)) {
+      size_t last = i + 1;
+      while (last < input_.size() && IsScalarCharacter(input_[last]))
+        last++;
+      table.Add(input_.substr(i, last - i),
+                static_cast<uint32_t>(i - chunk.begin));
+      i = last;
+      continue;
+    }
+    i++;
+  }
+
+  table.Build(chunk.text, chunk.term_begin, chunk.posting_begin,
+              chunk.postings);
+}
+
+std::vector<uint64_t> SearchIndex::Find(std::string_view query,
+                                        size_t limit) const {
+  std::vector<uint64_t> out;
+  std::string term(query);
+  Lowercase(term);
+  if (term.empty())
+    return out;
+
+  std::vector<std::shared_ptr<const Chunk>> chunks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    chunks = chunks_;
+  }
+
+  for (const auto& chunk : chunks) {
+    if (out.size() >= limit)
+      break;
+    if (chunk->posting_begin.empty())
+      continue;  // Not indexed yet.
+
+    const size_t first = out.size();
+    size_t low = 0;
+    size_t high = chunk->term_count();
+    while (low < high) {
+      const size_t middle = (low + high) / 2;
+      if (chunk->term(middle) < term)
+        low = middle + 1;
+      else
+        high = middle;
+    }
+    for (size_t i = low; i < chunk->term_count() &&
+                         chunk->term(i).substr(0, term.size()) == term;
+         ++i) {
+      for (uint32_t j = chunk->posting_begin[i];
+           j < chunk->posting_begin[i + 1]; ++j) {
+        out.push_back(chunk->begin + chunk->postings[j]);
+      }
+    }
+
+    // A token matches once, even through several of its terms.
+    std::sort(out.begin() + first, out.end());
+    out.erase(std::unique(out.begin() + first, out.end()), out.end());
+  }
+
+  if (out.size() > limit)
+    out.resize(limit);
+  return out;
+}
@@ -0,0 +1,94 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#ifndef JSON_TUI_SEARCH_INDEX_HPP
+#define JSON_TUI_SEARCH_INDEX_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// A term index over the keys and the string, number and boolean values of a
+// JSON input, built in the background by a pool of threads.
+//
+// The input is split into chunks, indexed independently. Each chunk maps its
+// terms, sorted, to the positions of the tokens containing them. The chunks
+// are queryable as soon as they are done, so matches appear while the rest is
+// still being indexed.
+//
+// A token is indexed as a whole, and by each of its words. The terms are
+// lowercased, and a query matches the terms it is a prefix of.
+class SearchIndex {
+ public:
+  // The chunks are split at the first boundary this far from their beginning.
+  // Smaller chunks make the first matches appear sooner, bigger ones make the
+  // queries cheaper.
+  static constexpr uint64_t kChunkSize = 4 << 20;
+
+  // Start indexing |input|, which must outlive the index. |boundaries| are
+  // sorted positions outside of strings, where the input can be split.
+  // |on_progress| is called from the worker threads, each time a chunk is
+  // done.
+  SearchIndex(std::string_view input,
+              const std::vector<uint64_t>& boundaries,
+              std::function<void()> on_progress = nullptr);
+
+  // Stop the workers.
+  ~SearchIndex();
+
+  SearchIndex(const SearchIndex&) = delete;
+  SearchIndex& operator=(const SearchIndex&) = delete;
+
+  // The sorted positions of the tokens matching |query| in the chunks indexed
+  // so far, at most |limit|. The position of a string is its opening quote.
+  // Thread-safe.
+  std::vector<uint64_t> Find(std::string_view query, size_t limit) const;
+
+  size_t chunk_count() const { return chunks_.size(); }
+  size_t indexed_chunk_count() const { return indexed_chunks_; }
+  bool done() const { return indexed_chunks_ == chunks_.size(); }
+
+  // Block until every chunk is indexed.
+  void Wait();
+
+ private:
+  struct Chunk {
+    uint64_t begin = 0;
+    uint64_t end = 0;
+    // The terms, sorted. Term i is text[term_begin[i]..term_begin[i+1]).
+    std::string text;
+    std::vector<uint32_t> term_begin;
+    // The postings of term i are in postings[posting_begin[i]..], up to
+    // posting_begin[i+1]. They are relative to |begin|.
+    std::vector<uint32_t> posting_begin;
+    std::vector<uint32_t> postings;
+
+    size_t term_count() const { return posting_begin.size() - 1; }
+    std::string_view term(size_t i) const {
+      return std::string_view(text).substr(term_begin[i],
+                                           term_begin[i + 1] - term_begin[i]);
+    }
+  };
+
+  void Work();
+  void IndexChunk(Chunk& chunk) const;
+
+  std::string_view input_;
+  std::function<void()> on_progress_;
+
+  mutable std::mutex mutex_;
+  std::vector<std::shared_ptr<const Chunk>> chunks_;  // Guarded by |mutex_|.
+  std::atomic<size_t> next_chunk_{0};
+  std::atomic<size_t> indexed_chunks_{0};
+  std::atomic<bool> stop_{false};
+  std::vector<std::thread> workers_;
+};
+
+#endif  // JSON_TUI_SEARCH_INDEX_HPP
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include "document.hpp"
+#include "search_index.hpp"
+
+TEST(SearchIndex, Find) {
+  const std::string input =
+      R"({"Name": "John Smith", "age": 42, "admin": true, )"
+      R"("tags": ["x-ray", "café"], "nested": {"name": "johnny"}})";
+  SearchIndex index(input, {});
+  index.Wait();
+  EXPECT_TRUE(index.done());
+
+  auto position = [&](std::string_view token) {
+    return static_cast<uint64_t>(input.find(token));
+  };
+
+  // Keys and values, as a whole or by words, ignoring the case.
+  EXPECT_EQ(index.Find("john", 10),
+            (std::vector<uint64_t>{position("\"John"), position("\"johnny")}));
+  EXPECT_EQ(index.Find("SMITH", 10),
+            (std::vector<uint64_t>{position("\"John")}));
+  EXPECT_EQ(index.Find("john smith", 10),
+            (std::vector<uint64_t>{position("\"John")}));
+  EXPECT_EQ(index.Find("name", 10),
+            (std::vector<uint64_t>{position("\"Name"), position("\"name")}));
+  EXPECT_EQ(index.Find("42", 10), (std::vector<uint64_t>{position("42")}));
+  EXPECT_EQ(index.Find("true", 10), (std::vector<uint64_t>{position("true")}));
+  EXPECT_EQ(index.Find("ray", 10), (std::vector<uint64_t>{position("\"x-")}));
+  EXPECT_EQ(index.Find("café", 10),
+            (std::vector<uint64_t>{position("\"caf")}));
+
+  EXPECT_TRUE(index.Find("", 10).empty());
+  EXPECT_TRUE(index.Find("smithy", 10).empty());
+  EXPECT_EQ(index.Find("john", 1).size(), 1u);
+}
+
+TEST(SearchIndex, Chunks) {
+  std::string input = "[";
+  for (int i = 0; input.size() < 3 * SearchIndex::kChunkSize; ++i)
+    input += "{\"id\": " + std::to_string(i) + ", \"key\": \"{value\"},\n";
+  input += "{\"id\": \"last\"}]";
+
+  Document document;
+  std::string error;
+  ASSERT_TRUE(Document::ParseLazily(input, document, error)) << error;
+
+  std::atomic<int> progress = 0;
+  SearchIndex index(input, document.SplitPoints(SearchIndex::kChunkSize),
+                    [&] { progress++; });
+  index.Wait();
+  EXPECT_GE(index.chunk_count(), 3u);
+  EXPECT_EQ(progress, static_cast<int>(index.chunk_count()));
+
+  const auto ids = index.Find("id", 1 << 30);
+  ASSERT_GT(ids.size(), 1000u);
+  EXPECT_TRUE(std::is_sorted(ids.begin(), ids.end()));
+  for (uint64_t id : ids)
+    ASSERT_EQ(input.substr(id, 4), "\"id\"");
+  EXPECT_EQ(index.Find("value", 1 << 30).size(), ids.size() - 1);
+  EXPECT_EQ(index.Find("last", 10), (std::vector<uint64_t>{input.size() - 8}));
+  EXPECT_EQ(index.Find("id", 100).size(), 100u);
+}
@@ -0,0 +1,140 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+
+#include "stats.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+std::string FormatMilliseconds(double milliseconds) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.3f", milliseconds);
+  return buffer;
+}
+
+}  // namespace
+
+void Stats::AddPhase(const std::string& name, Clock::time_point begin) {
+  const std::chrono::duration<double, std::milli> duration =
+      Clock::now() - begin;
+  phases_.emplace_back(name, duration.count());
+}
+
+void Stats::SetCount(const std::string& name, uint64_t value) {
+  for (auto& count : counts_) {
+    if (count.first == name) {
+      count.second = value;
+      return;
+    }
+  }
+  counts_.emplace_back(name, value);
+}
+
+void Stats::AddFrameLatency(Clock::duration latency) {
+  const double milliseconds =
+      std::chrono::duration<double, std::milli>(latency).count();
+  if (latencies_.size() < kWindow)
+    latencies_.push_back(milliseconds);
+  else
+    latencies_[frames_ % kWindow] = milliseconds;
+  frames_++;
+}
+
+std::array<size_t, Stats::kBuckets.size() + 1> Stats::Histogram() const {
+  std::array<size_t, kBuckets.size() + 1> histogram = {};
+  for (double latency : latencies_) {
+    const size_t bucket =
+        std::lower_bound(kBuckets.begin(), kBuckets.end(), latency) -
+        kBuckets.begin();
+    histogram[bucket]++;
+  }
+  return histogram;
+}
+
+double Stats::Percentile(double percentile) const {
+  if (latencies_.empty())
+    return 0;
+  std::vector<double> sorted = latencies_;
+  const double rank = percentile / 100 * static_cast<double>(sorted.size());
+  const size_t index =
+      std::min(sorted.size() - 1, static_cast<size_t>(rank));
+  std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+  return sorted[index];
+}
+
+// static
+uint64_t Stats::PeakRSS() {
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return 0;
+  return counters.PeakWorkingSetSize;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#if defined(__APPLE__)
+  return static_cast<uint64_t>(usage.ru_maxrss);  // Bytes.
+#else
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;  // Kilobytes.
+#endif
+#endif
+}
+
+std::vector<std::string> Stats::Summary() const {
+  std::vector<std::string> lines;
+  for (const auto& [name, milliseconds] : phases_)
+    lines.push_back(name + ": " + FormatMilliseconds(milliseconds) + " ms");
+  for (const auto& [name, value] : counts_)
+    lines.push_back(name + ": " + std::to_string(value));
+  lines.push_back("peak RSS: " + std::to_string(PeakRSS() >> 20) + " MiB");
+  lines.push_back("frames: " + std::to_string(frames_) +
+                  ", latency p50 " + FormatMilliseconds(Percentile(50)) +
+                  " ms, p90 " + FormatMilliseconds(Percentile(90)) +
+                  " ms, p99 " + FormatMilliseconds(Percentile(99)) +
+                  " ms, max " + FormatMilliseconds(Percentile(100)) + " ms");
+  return lines;
+}
+
+// The names are written by the program, and never need escaping.
+std::string Stats::ToJSON() const {
+  std::string out = "{\n  \"phases_ms\": {";
+  for (size_t i = 0; i < phases_.size(); ++i) {
+    out += i ? ", " : "";
+    out += "\"" + phases_[i].first + "\": " +
+           FormatMilliseconds(phases_[i].second);
+  }
+  out += "},\n  \"counts\": {";
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    out += i ? ", " : "";
+    out += "\"" + counts_[i].first + "\": " +
+           std::to_string(counts_[i].second);
+  }
+  out += "},\n  \"peak_rss_bytes\": " + std::to_string(PeakRSS()) + ",\n";
+  out += "  \"frames\": " + std::to_string(frames_) + ",\n";
+  out += "  \"frame_latency_ms\": {";
+  out += "\"p50\": " + FormatMilliseconds(Percentile(50)) + ", ";
+  out += "\"p90\": " + FormatMilliseconds(Percentile(90)) + ", ";
+  out += "\"p99\": " + FormatMilliseconds(Percentile(99)) + ", ";
+  out += "\"max\": " + FormatMilliseconds(Percentile(100)) + ", ";
+  out += "\"histogram\": [";
+  const auto histogram = Histogram();
+  for (size_t i = 0; i < histogram.size(); ++i) {
+    out += i ? ", " : "";
+    out += "{\"le\": ";
+    out += i < kBuckets.size() ? FormatMilliseconds(kBuckets[i]) : "null";
+    out += ", \"count\": " + std::to_string(histogram[i]) + "}";
+  }
+  out += "]}\n}\n";
+  return out;
+}
@@ -0,0 +1,69 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#ifndef JSON_TUI_STATS_HPP
+#define JSON_TUI_STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Where the time goes: the duration of each phase of the startup, the size of
+// the document, the memory used, and the latency between an event and the
+// frame displaying its effect. Used by --stats, to attach real numbers to bug
+// reports.
+class Stats {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // The frame latencies are kept for this number of frames.
+  static constexpr size_t kWindow = 1024;
+
+  // The upper bounds of the latency buckets, in milliseconds. A last bucket
+  // holds the slower frames.
+  static constexpr std::array<double, 8> kBuckets = {1,  2,  4,   8,
+                                                     16, 32, 64, 128};
+
+  // Record the phase |name|, from |begin| to now.
+  void AddPhase(const std::string& name, Clock::time_point begin);
+
+  // Set the counter |name|, like the number of nodes.
+  void SetCount(const std::string& name, uint64_t value);
+
+  void AddFrameLatency(Clock::duration latency);
+
+  // The latencies of the last kWindow frames, in each bucket.
+  std::array<size_t, kBuckets.size() + 1> Histogram() const;
+
+  // The |percentile| (in [0, 100]) of the last frame latencies, in
+  // milliseconds.
+  double Percentile(double percentile) const;
+
+  // The peak resident set size of the process, in bytes. 0 if unknown.
+  static uint64_t PeakRSS();
+
+  // One line per phase, counter, and the frame latencies.
+  std::vector<std::string> Summary() const;
+
+  std::string ToJSON() const;
+
+  const std::vector<std::pair<std::string, double>>& phases() const {
+    return phases_;
+  }
+  const std::vector<std::pair<std::string, uint64_t>>& counts() const {
+    return counts_;
+  }
+  uint64_t frames() const { return frames_; }
+
+ private:
+  std::vector<std::pair<std::string, double>> phases_;  // In milliseconds.
+  std::vector<std::pair<std::string, uint64_t>> counts_;
+  std::vector<double> latencies_;  // Ring buffer, in milliseconds.
+  uint64_t frames_ = 0;
+};
+
+#endif  // JSON_TUI_STATS_HPP
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include "stats.hpp"
+
+using namespace std::chrono_literals;
+
+TEST(Stats, FrameLatency) {
+  Stats stats;
+  EXPECT_EQ(stats.Percentile(50), 0);
+  for (int i = 1; i <= 100; ++i)
+    stats.AddFrameLatency(std::chrono::milliseconds(i));
+  EXPECT_EQ(stats.frames(), 100u);
+  EXPECT_EQ(stats.Percentile(0), 1);
+  EXPECT_EQ(stats.Percentile(50), 51);
+  EXPECT_EQ(stats.Percentile(100), 100);
+
+  const auto histogram = stats.Histogram();
+  EXPECT_EQ(histogram[0], 1u);   // <= 1 ms
+  EXPECT_EQ(histogram[1], 1u);   // <= 2 ms
+  EXPECT_EQ(histogram[2], 2u);   // <= 4 ms
+  EXPECT_EQ(histogram[6], 32u);  // <= 64 ms
+  EXPECT_EQ(histogram[7], 36u);  // <= 128 ms
+  EXPECT_EQ(histogram[8], 0u);
+
+  // Only the last frames are kept.
+  for (size_t i = 0; i < Stats::kWindow; ++i)
+    stats.AddFrameLatency(200ms);
+  EXPECT_EQ(stats.Percentile(0), 200);
+  EXPECT_EQ(stats.Histogram()[8], Stats::kWindow);
+}
+
+TEST(Stats, Report) {
+  Stats stats;
+  stats.AddPhase("parse", Stats::Clock::now());
+  stats.SetCount("nodes", 3);
+  stats.SetCount("nodes", 42);
+  stats.AddFrameLatency(3ms);
+  ASSERT_EQ(stats.phases().size(), 1u);
+  EXPECT_GE(stats.phases()[0].second, 0);
+  ASSERT_EQ(stats.counts().size(), 1u);
+  EXPECT_EQ(stats.counts()[0].second, 42u);
+  EXPECT_GT(Stats::PeakRSS(), 0u);
+
+  const std::string json = stats.ToJSON();
+  EXPECT_NE(json.find("\"parse\": "), std::string::npos);
+  EXPECT_NE(json.find("\"nodes\": 42"), std::string::npos);
+  EXPECT_NE(json.find("\"frames\": 1,"), std::string::npos);
+  EXPECT_NE(json.find("{\"le\": 4.000, \"count\": 1}"), std::string::npos);
+  EXPECT_NE(json.find("{\"le\": null, \"count\": 0}"), std::string::npos);
+}
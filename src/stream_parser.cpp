@@ -0,0 +1,274 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+
+#include "stream_parser.hpp"
+
+#include <algorithm>
+
+namespace {
+
+bool IsWhitespace(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+std::string_view Trim(std::string_view text) {
+  while (!text.empty() && IsWhitespace(text.front()))
+    text.remove_prefix(1);
+  while (!text.empty() && IsWhitespace(text.back()))
+    text.remove_suffix(1);
+  return text;
+}
+
+// Parse an item, wrapped into |open| and |close|. The error is positioned in
+// the wrapped text.
+bool Parse(std::string_view text,
+           char open,
+           char close,
+           StreamItem& item,
+           Document::ParseError& error) {
+  std::string input;
+  input.reserve(text.size() + 2);
+  input += open;
+  input += text;
+  input += close;
+  return Document::ParseOwned(std::move(input), item.document, error);
+}
+
+}  // namespace
+
+bool StreamParser::Feed(std::string_view chunk,
+                        std::vector<StreamItem>& items) {
+  if (!error_.empty())
+    return false;
+
+  buffer_.append(chunk);
+  if (lines_)
+    return FeedLines(items);
+
+  for (; index_ < buffer_.size(); ++index_) {
+    const char c = buffer_[index_];
+
+    if (root_ == Root::Unknown) {
+      if (IsWhitespace(c))
+        continue;
+      root_ = c == '{' ? Root::Object : c == '[' ? Root::Array : Root::Value;
+      if (root_ == Root::Value) {
+        item_begin_ = index_;
+        index_ = buffer_.size();
+        break;
+      }
+      depth_ = 1;
+      item_begin_ = index_ + 1;
+      continue;
+    }
+
+    if (root_ == Root::Value) {
+      index_ = buffer_.size();
+      break;
+    }
+
+    if (done_) {
+      if (!IsWhitespace(c))
+        return Fail("unexpected character after the end of the document");
+      continue;
+    }
+
+    if (in_string_) {
+      if (escaped_)
+        escaped_ = false;
+      else if (c == '\\')
+        escaped_ = true;
+      else if (c == '"')
+        in_string_ = false;
+      continue;
+    }
+
+    switch (c) {
+      case '"':
+        in_string_ = true;
+        break;
+
+      case '{':
+      case '[':
+        depth_++;
+        break;
+
+      case '}':
+      case ']':
+        if (--depth_ > 0)
+          break;
+        if (c != (root_ == Root::Object ? '}' : ']'))
+          return Fail("mismatched closing bracket");
+        if (!EmitItem(index_, /*is_last=*/true, items))
+          return false;
+        done_ = true;
+        break;
+
+      case ',':
+        if (depth_ == 1 && !EmitItem(index_, /*is_last=*/false, items))
+          return false;
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  if (root_ != Root::Value)
+    DropConsumedBytes();
+  return true;
+}
+
+bool StreamParser::End(std::vector<StreamItem>& items) {
+  if (!error_.empty())
+    return false;
+
+  if (lines_) {
+    if (!EmitLine(std::string_view(buffer_).substr(item_begin_), items))
+      return false;
+    if (has_pending_) {
+      pending_.is_last = true;
+      items.push_back(std::move(pending_));
+      has_pending_ = false;
+    }
+    root_ = Root::Lines;
+    done_ = true;
+    return true;
+  }
+
+  switch (root_) {
+    case Root::Unknown:
+      return Fail("the input is empty");
+
+    case Root::Value: {
+      StreamItem item;
+      item.is_last = true;
+      Document::ParseError error;
+      const std::string_view text =
+          Trim(std::string_view(buffer_).substr(item_begin_));
+      if (!Parse(text, '[', ']', item, error))
+        return Fail(error.message, Locate(text, error));
+      items.push_back(std::move(item));
+      done_ = true;
+      return true;
+    }
+
+    case Root::Object:
+    case Root::Array:
+    case Root::Lines:
+      if (!done_)
+        return Fail("unexpected end of input");
+      return true;
+  }
+  return true;
+}
+
+bool StreamParser::EmitItem(size_t end,
+                            bool is_last,
+                            std::vector<StreamItem>& items) {
+  std::string_view text(buffer_.data() + item_begin_, end - item_begin_);
+  item_begin_ = end + 1;
+
+  if (Trim(text).empty()) {
+    // The closing bracket of an empty container.
+    if (is_last && !has_items_)
+      return true;
+    return Fail("expected a value");
+  }
+  has_items_ = true;
+
+  StreamItem item;
+  item.is_last = is_last;
+  Document::ParseError error;
+  const bool object = root_ == Root::Object;
+  if (!Parse(text, object ? '{' : '[', object ? '}' : ']', item, error))
+    return Fail(error.message, Locate(text, error));
+  items.push_back(std::move(item));
+  return true;
+}
+
+bool StreamParser::FeedLines(std::vector<StreamItem>& items) {
+  root_ = Root::Lines;
+  while (true) {
+    const size_t end = buffer_.find('\n', index_);
+    if (end == std::string::npos)
+      break;
+    index_ = end;
+    std::string_view line(buffer_.data() + item_begin_, end - item_begin_);
+    if (!EmitLine(line, items))
+      return false;
+    index_ = item_begin_ = end + 1;
+  }
+  index_ = buffer_.size();
+  DropConsumedBytes();
+  return true;
+}
+
+bool StreamParser::EmitLine(std::string_view line,
+                            std::vector<StreamItem>& items) {
+  line = Trim(line);
+  if (line.empty())
+    return true;
+
+  StreamItem item;
+  Document::ParseError error;
+  if (!Parse(line, '[', ']', item, error))
+    return Fail(error.message, Locate(line, error));
+  if (has_pending_)
+    items.push_back(std::move(pending_));
+  pending_ = std::move(item);
+  has_pending_ = true;
+  return true;
+}
+
+void StreamParser::Release(std::vector<StreamItem>& items) {
+  if (!has_pending_)
+    return;
+  items.push_back(std::move(pending_));
+  has_pending_ = false;
+}
+
+// Drop the consumed bytes. The parsed items own their data.
+void StreamParser::DropConsumedBytes() {
+  if (item_begin_ == 0)
+    return;
+  for (size_t i = 0; i < item_begin_; ++i) {
+    if (buffer_[i] == '\n') {
+      line_++;
+      line_begin_ = offset_ + i + 1;
+    }
+  }
+  buffer_.erase(0, item_begin_);
+  offset_ += item_begin_;
+  index_ -= item_begin_;
+  item_begin_ = 0;
+}
+
+bool StreamParser::Fail(const std::string& message) {
+  return Fail(message, position());
+}
+
+// Like Document, report the line and the column of the error, in the whole
+// input.
+bool StreamParser::Fail(const std::string& message, size_t position) {
+  size_t line = line_;
+  size_t line_begin = line_begin_;
+  for (size_t i = offset_; i < position && i - offset_ < buffer_.size(); ++i) {
+    if (buffer_[i - offset_] == '\n') {
+      line++;
+      line_begin = i + 1;
+    }
+  }
+  error_ = "parse error at line " + std::to_string(line) + ", column " +
+           std::to_string(position - line_begin + 1) + ": " + message;
+  return false;
+}
+
+size_t StreamParser::Locate(std::string_view text,
+                            const Document::ParseError& error) const {
+  // The wrapped text begins with the opening bracket.
+  const size_t index = std::min(std::max<size_t>(error.position, 1) - 1,
+                                text.size());
+  return offset_ + static_cast<size_t>(text.data() - buffer_.data()) + index;
+}
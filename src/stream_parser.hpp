@@ -0,0 +1,101 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#ifndef JSON_TUI_STREAM_PARSER_HPP
+#define JSON_TUI_STREAM_PARSER_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "document.hpp"
+
+// A top-level item of a document: a member of the root object, an element of
+// the root array, or the root itself when it is not a container.
+struct StreamItem {
+  // The item is the only child of the document's root, so that object members
+  // keep their key.
+  Document document;
+  bool is_last = false;
+
+  Document::Value value() const { return document.root().child(0); }
+};
+
+// Parse a JSON document received progressively. The top-level items are
+// returned as soon as they are complete, so that they can be displayed while
+// the rest of the document is still being produced.
+class StreamParser {
+ public:
+  enum class Root {
+    Unknown,  // Nothing but whitespace has been received.
+    Object,
+    Array,
+    Value,  // A scalar. It is returned once the input ends.
+    Lines,  // JSON Lines: one value per line.
+  };
+
+  // When |lines| is true, the input is read as JSON Lines. Every line is an
+  // item of a virtual array.
+  explicit StreamParser(bool lines = false) : lines_(lines) {}
+
+  // Consume |chunk|. Append the completed items to |items|. Return false on
+  // error.
+  bool Feed(std::string_view chunk, std::vector<StreamItem>& items);
+
+  // Signal the end of the input. Append the remaining items to |items|.
+  // Return false on error.
+  bool End(std::vector<StreamItem>& items);
+
+  // JSON Lines: the last record is held back until the next one, to know
+  // whether it is the last. Append it to |items| now, as not the last. For
+  // inputs that might never end, like a followed file.
+  void Release(std::vector<StreamItem>& items);
+
+  Root root() const { return root_; }
+  bool done() const { return done_; }
+  const std::string& error() const { return error_; }
+
+  // The number of bytes consumed so far.
+  size_t position() const { return offset_ + index_; }
+
+ private:
+  bool EmitItem(size_t end, bool is_last, std::vector<StreamItem>& items);
+  bool FeedLines(std::vector<StreamItem>& items);
+  bool EmitLine(std::string_view line, std::vector<StreamItem>& items);
+  void DropConsumedBytes();
+  bool Fail(const std::string& message);
+  bool Fail(const std::string& message, size_t position);
+  // The position in the input of |error|, from parsing |text|.
+  size_t Locate(std::string_view text,
+                const Document::ParseError& error) const;
+
+  bool lines_;
+
+  Root root_ = Root::Unknown;
+  bool done_ = false;
+  std::string error_;
+
+  // The bytes not consumed yet. |offset_| is the position of |buffer_[0]| in
+  // the input.
+  std::string buffer_;
+  size_t offset_ = 0;
+  size_t index_ = 0;
+  // The line of |buffer_[0]|, and the position where it begins, to locate the
+  // errors.
+  size_t line_ = 1;
+  size_t line_begin_ = 0;
+
+  // Scanner state.
+  int depth_ = 0;
+  bool in_string_ = false;
+  bool escaped_ = false;
+  size_t item_begin_ = 0;
+  bool has_items_ = false;
+
+  // JSON Lines: the last record is held back until the next one, to know
+  // whether it is the last.
+  StreamItem pending_;
+  bool has_pending_ = false;
+};
+
+#endif  // JSON_TUI_STREAM_PARSER_HPP
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "stream_parser.hpp"
+
+namespace {
+
+std::vector<StreamItem> FeedBytes(StreamParser& parser,
+                                  std::string_view input) {
+  std::vector<StreamItem> items;
+  for (char c : input)
+    EXPECT_TRUE(parser.Feed(std::string_view(&c, 1), items));
+  return items;
+}
+
+}  // namespace
+
+TEST(StreamParser, Array) {
+  StreamParser parser;
+  std::vector<StreamItem> items;
+  EXPECT_TRUE(parser.Feed("  [1, \"a,]\", [2, 3", items));
+  EXPECT_EQ(parser.root(), StreamParser::Root::Array);
+  ASSERT_EQ(items.size(), 2u);
+  EXPECT_EQ(items[0].value().lexeme(), "1");
+  EXPECT_EQ(items[1].value().string(), "a,]");
+  EXPECT_FALSE(items[1].is_last);
+
+  EXPECT_TRUE(parser.Feed("], {\"b\": null}]", items));
+  ASSERT_EQ(items.size(), 4u);
+  EXPECT_EQ(items[2].value().size(), 2u);
+  EXPECT_EQ(items[2].value().child(1).lexeme(), "3");
+  EXPECT_EQ(items[3].value().child(0).key(), "b");
+  EXPECT_TRUE(items[3].value().child(0).is_null());
+  EXPECT_TRUE(items[3].is_last);
+  EXPECT_TRUE(parser.done());
+  EXPECT_TRUE(parser.End(items));
+}
+
+TEST(StreamParser, Object) {
+  StreamParser parser;
+  auto items = FeedBytes(parser, R"({"a\"": {"x": [1]}, "b" : true})");
+  EXPECT_EQ(parser.root(), StreamParser::Root::Object);
+  ASSERT_EQ(items.size(), 2u);
+  EXPECT_EQ(items[0].value().key(), "a\"");
+  EXPECT_EQ(items[0].value().child(0).key(), "x");
+  EXPECT_EQ(items[0].value().child(0).child(0).lexeme(), "1");
+  EXPECT_EQ(items[1].value().key(), "b");
+  EXPECT_TRUE(items[1].value().boolean());
+  EXPECT_TRUE(items[1].is_last);
+  EXPECT_TRUE(parser.End(items));
+}
+
+TEST(StreamParser, Empty) {
+  StreamParser parser;
+  std::vector<StreamItem> items;
+  EXPECT_TRUE(parser.Feed("[ ]", items));
+  EXPECT_TRUE(parser.End(items));
+  EXPECT_TRUE(items.empty());
+}
+
+TEST(StreamParser, Value) {
+  StreamParser parser;
+  std::vector<StreamItem> items;
+  EXPECT_TRUE(parser.Feed(" 12", items));
+  EXPECT_TRUE(parser.Feed("34 ", items));
+  EXPECT_TRUE(items.empty());
+  EXPECT_TRUE(parser.End(items));
+  ASSERT_EQ(items.size(), 1u);
+  EXPECT_EQ(items[0].value().lexeme(), "1234");
+}
+
+TEST(StreamParser, Errors) {
+  {
+    StreamParser parser;
+    std::vector<StreamItem> items;
+    EXPECT_FALSE(parser.Feed("[1, tru, 3]", items));
+    EXPECT_FALSE(parser.error().empty());
+  }
+  {
+    // The errors are located in the whole input, not in the item.
+    StreamParser parser;
+    std::vector<StreamItem> items;
+    EXPECT_TRUE(parser.Feed("[1,\n  2,", items));
+    EXPECT_FALSE(parser.Feed("\n  tru, 3]", items));
+    EXPECT_EQ(parser.error(),
+              "parse error at line 3, column 3: invalid literal");
+  }
+  {
+    StreamParser parser(/*lines=*/true);
+    std::vector<StreamItem> items;
+    EXPECT_TRUE(parser.Feed("1\n2\n", items));
+    EXPECT_FALSE(parser.Feed("[3,\n", items));
+    EXPECT_EQ(parser.error().rfind("parse error at line 3, column 4: ", 0), 0u)
+        << parser.error();
+  }
+  {
+    StreamParser parser;
+    std::vector<StreamItem> items;
+    EXPECT_TRUE(parser.Feed("[1, 2", items));
+    EXPECT_FALSE(parser.End(items));
+  }
+  {
+    StreamParser parser;
+    std::vector<StreamItem> items;
+    EXPECT_FALSE(parser.Feed("{\"a\": 1]", items));
+  }
+  {
+    StreamParser parser;
+    std::vector<StreamItem> items;
+    EXPECT_FALSE(parser.Feed("[1,,2]", items));
+  }
+  {
+    StreamParser parser;
+    std::vector<StreamItem> items;
+    EXPECT_FALSE(parser.Feed("{\"a\" 1, \"b\": 2}", items));
+  }
+}
+
+TEST(StreamParser, Lines) {
+  StreamParser parser(/*lines=*/true);
+  std::vector<StreamItem> items;
+  EXPECT_TRUE(parser.Feed("{\"a\": 1}\n\n[2,", items));
+  EXPECT_EQ(parser.root(), StreamParser::Root::Lines);
+  // The first record is held back until the next one starts.
+  EXPECT_TRUE(items.empty());
+
+  EXPECT_TRUE(parser.Feed(" 3]\r\n\"x\"", items));
+  ASSERT_EQ(items.size(), 1u);
+  EXPECT_EQ(items[0].value().child(0).key(), "a");
+  EXPECT_FALSE(items[0].is_last);
+
+  EXPECT_TRUE(parser.End(items));
+  ASSERT_EQ(items.size(), 3u);
+  EXPECT_EQ(items[1].value().size(), 2u);
+  EXPECT_FALSE(items[1].is_last);
+  EXPECT_EQ(items[2].value().string(), "x");
+  EXPECT_TRUE(items[2].is_last);
+  EXPECT_TRUE(parser.done());
+
+  StreamParser invalid(/*lines=*/true);
+  EXPECT_FALSE(invalid.Feed("1\n{\n", items));
+  EXPECT_FALSE(invalid.error().empty());
+}
+
+TEST(StreamParser, Release) {
+  StreamParser parser(/*lines=*/true);
+  std::vector<StreamItem> items;
+  EXPECT_TRUE(parser.Feed("1\n2\n", items));
+  ASSERT_EQ(items.size(), 1u);
+  parser.Release(items);
+  ASSERT_EQ(items.size(), 2u);
+  EXPECT_EQ(items[1].value().lexeme(), "2");
+  EXPECT_FALSE(items[1].is_last);
+
+  // Nothing is held back anymore.
+  parser.Release(items);
+  EXPECT_TRUE(parser.Feed("3", items));
+  EXPECT_EQ(items.size(), 2u);
+  EXPECT_TRUE(parser.End(items));
+  ASSERT_EQ(items.size(), 3u);
+  EXPECT_TRUE(items[2].is_last);
+}
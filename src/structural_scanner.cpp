@@ -0,0 +1,267 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+
+#include "structural_scanner.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define JSON_TUI_X86_64
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define JSON_TUI_TARGET(name) __attribute__((target(name)))
+#else
+#define JSON_TUI_TARGET(name)
+#endif
+
+namespace {
+
+constexpr size_t kBlockSize = kScanBlockSize;
+
+struct Masks {
+  uint64_t quote = 0;
+  uint64_t backslash = 0;
+  uint64_t bracket = 0;
+  uint64_t comma = 0;
+};
+
+int CountTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index = 0;
+  _BitScanForward64(&index, value);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(value);
+#endif
+}
+
+// Bit i of the result is the xor of the bits 0..i of |value|.
+uint64_t PrefixXor(uint64_t value) {
+  value ^= value << 1;
+  value ^= value << 2;
+  value ^= value << 4;
+  value ^= value << 8;
+  value ^= value << 16;
+  value ^= value << 32;
+  return value;
+}
+
+// Return the characters escaped by a backslash. A sequence of backslashes
+// escapes the next character only when its length is odd. |carry| tells
+// whether the first character of the block is escaped, and is updated for the
+// next one.
+uint64_t FindEscaped(uint64_t backslash, uint64_t& carry) {
+  constexpr uint64_t kEvenBits = 0x5555555555555555ULL;
+  backslash &= ~carry;
+  const uint64_t follows_escape = backslash << 1 | carry;
+  // Adding the sequences starting on an odd bit to themselves clears them, and
+  // marks the bit following them.
+  const uint64_t odd_starts = backslash & ~kEvenBits & ~follows_escape;
+  const uint64_t sequences = odd_starts + backslash;
+  carry = sequences < backslash ? 1 : 0;
+  const uint64_t invert_mask = sequences << 1;
+  return (kEvenBits ^ invert_mask) & follows_escape;
+}
+
+Masks ClassifyScalar(const char* block) {
+  Masks masks;
+  for (size_t i = 0; i < kBlockSize; ++i) {
+    const uint64_t bit = uint64_t(1) << i;
+    const char c = block[i];
+    if (c == '"')
+      masks.quote |= bit;
+    else if (c == '\\')
+      masks.backslash |= bit;
+    else if ((c | 0x20) == '{' || (c | 0x20) == '}')  // Also '[' and ']'.
+      masks.bracket |= bit;
+    else if (c == ',')
+      masks.comma |= bit;
+  }
+  return masks;
+}
+
+#if defined(JSON_TUI_X86_64)
+
+// Widen the result of a movemask instruction.
+uint64_t Mask16(int mask) {
+  return static_cast<uint16_t>(mask);
+}
+uint64_t Mask32(int mask) {
+  return static_cast<uint32_t>(mask);
+}
+
+JSON_TUI_TARGET("sse2") Masks ClassifySSE2(const char* block) {
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i open = _mm_set1_epi8('{');
+  const __m128i close = _mm_set1_epi8('}');
+  const __m128i lowercase = _mm_set1_epi8(0x20);  // '[' -> '{', ']' -> '}'.
+  const __m128i comma = _mm_set1_epi8(',');
+  Masks masks;
+  for (size_t i = 0; i < kBlockSize; i += 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+    const __m128i folded = _mm_or_si128(chunk, lowercase);
+    const __m128i bracket = _mm_or_si128(_mm_cmpeq_epi8(folded, open),
+                                         _mm_cmpeq_epi8(folded, close));
+    masks.quote |= Mask16(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote))) << i;
+    masks.backslash |=
+        Mask16(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash))) << i;
+    masks.bracket |= Mask16(_mm_movemask_epi8(bracket)) << i;
+    masks.comma |= Mask16(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, comma))) << i;
+  }
+  return masks;
+}
+
+JSON_TUI_TARGET("avx2") Masks ClassifyAVX2(const char* block) {
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i backslash = _mm256_set1_epi8('\\');
+  const __m256i open = _mm256_set1_epi8('{');
+  const __m256i close = _mm256_set1_epi8('}');
+  const __m256i lowercase = _mm256_set1_epi8(0x20);  // '[' -> '{', ']' -> '}'.
+  const __m256i comma = _mm256_set1_epi8(',');
+  Masks masks;
+  for (size_t i = 0; i < kBlockSize; i += 32) {
+    const __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+    const __m256i folded = _mm256_or_si256(chunk, lowercase);
+    const __m256i bracket = _mm256_or_si256(_mm256_cmpeq_epi8(folded, open),
+                                            _mm256_cmpeq_epi8(folded, close));
+    masks.quote |=
+        Mask32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote))) << i;
+    masks.backslash |=
+        Mask32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, backslash))) << i;
+    masks.bracket |= Mask32(_mm256_movemask_epi8(bracket)) << i;
+    masks.comma |=
+        Mask32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, comma))) << i;
+  }
+  return masks;
+}
+
+bool CPUSupportsAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  if (!osxsave || (_xgetbv(0) & 0x6) != 0x6)
+    return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif  // JSON_TUI_X86_64
+
+template <Masks (*Classify)(const char*)>
+void Scan(std::string_view input,
+          uint64_t base,
+          ScanState& state,
+          std::vector<uint64_t>& brackets,
+          std::vector<uint64_t>* commas) {
+  auto scan_block = [&](const char* block, uint64_t position) {
+    const Masks masks = Classify(block);
+    const uint64_t escaped = FindEscaped(masks.backslash, state.escape_carry);
+    // The opening quotes are part of the string, the closing ones aren't.
+    const uint64_t in_string =
+        PrefixXor(masks.quote & ~escaped) ^ state.string_carry;
+    state.string_carry = 0 - (in_string >> 63);
+
+    uint64_t bracket = masks.bracket & ~escaped & ~in_string;
+    while (bracket) {
+      brackets.push_back(position + CountTrailingZeros(bracket));
+      bracket &= bracket - 1;
+    }
+    if (!commas)
+      return;
+    uint64_t comma = masks.comma & ~escaped & ~in_string;
+    while (comma) {
+      commas->push_back(position + CountTrailingZeros(comma));
+      comma &= comma - 1;
+    }
+  };
+
+  size_t position = 0;
+  for (; position + kBlockSize <= input.size(); position += kBlockSize)
+    scan_block(input.data() + position, base + position);
+
+  // Pad the last block with whitespace.
+  if (position < input.size()) {
+    char block[kBlockSize];
+    std::memset(block, ' ', kBlockSize);
+    std::memcpy(block, input.data() + position, input.size() - position);
+    scan_block(block, base + position);
+  }
+}
+
+}  // namespace
+
+ScanKernel BestScanKernel() {
+  static const ScanKernel kernel = IsSupported(ScanKernel::AVX2)
+                                       ? ScanKernel::AVX2
+                                   : IsSupported(ScanKernel::SSE2)
+                                       ? ScanKernel::SSE2
+                                       : ScanKernel::Scalar;
+  return kernel;
+}
+
+bool IsSupported(ScanKernel kernel) {
+  switch (kernel) {
+    case ScanKernel::Scalar:
+      return true;
+#if defined(JSON_TUI_X86_64)
+    case ScanKernel::SSE2:
+      return true;  // Part of x86-64.
+    case ScanKernel::AVX2:
+      return CPUSupportsAVX2();
+#else
+    case ScanKernel::SSE2:
+    case ScanKernel::AVX2:
+      return false;
+#endif
+  }
+  return false;
+}
+
+StructuralScanner::StructuralScanner(ScanKernel kernel)
+    : kernel_(IsSupported(kernel) ? kernel : ScanKernel::Scalar) {}
+
+StructuralScanner::StructuralScanner(const ScanState& state, ScanKernel kernel)
+    : StructuralScanner(kernel) {
+  state_ = state;
+}
+
+void StructuralScanner::Scan(std::string_view part,
+                             std::vector<uint64_t>& brackets,
+                             std::vector<uint64_t>* commas) {
+  const uint64_t base = state_.position;
+  switch (kernel_) {
+#if defined(JSON_TUI_X86_64)
+    case ScanKernel::SSE2:
+      ::Scan<ClassifySSE2>(part, base, state_, brackets, commas);
+      break;
+    case ScanKernel::AVX2:
+      ::Scan<ClassifyAVX2>(part, base, state_, brackets, commas);
+      break;
+#endif
+    default:
+      ::Scan<ClassifyScalar>(part, base, state_, brackets, commas);
+      break;
+  }
+  state_.position += part.size();
+}
+
+bool ScanBrackets(std::string_view input,
+                  std::vector<uint64_t>& brackets,
+                  ScanKernel kernel) {
+  StructuralScanner scanner(kernel);
+  scanner.Scan(input, brackets);
+  return !scanner.in_string();
+}
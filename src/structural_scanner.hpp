@@ -0,0 +1,69 @@
+// Copyright 2022 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#ifndef JSON_TUI_STRUCTURAL_SCANNER_HPP
+#define JSON_TUI_STRUCTURAL_SCANNER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Locate the brackets and the commas of a JSON document, ignoring the ones
+// inside strings. Like in strings, a backslash escapes the next character
+// everywhere.
+//
+// The input is processed in blocks of |kScanBlockSize| bytes. Each block is
+// turned into bitmasks of its quotes, backslashes, brackets and commas, using
+// SIMD instructions when the CPU supports them. The escaped characters and the
+// strings are then computed with bitwise arithmetic, without branching on
+// every byte.
+constexpr size_t kScanBlockSize = 64;
+
+enum class ScanKernel {
+  Scalar,
+  SSE2,
+  AVX2,
+};
+
+// The fastest kernel supported by the CPU.
+ScanKernel BestScanKernel();
+bool IsSupported(ScanKernel kernel);
+
+// The state of a scan between two parts. A scan can resume from it.
+struct ScanState {
+  uint64_t position = 0;
+  uint64_t escape_carry = 0;  // Whether the next character is escaped.
+  uint64_t string_carry = 0;  // All ones inside a string.
+};
+
+// Scan an input given in several parts, keeping the state between them.
+class StructuralScanner {
+ public:
+  explicit StructuralScanner(ScanKernel kernel = BestScanKernel());
+  explicit StructuralScanner(const ScanState& state,
+                             ScanKernel kernel = BestScanKernel());
+
+  // Append the position of every unescaped bracket outside of the strings to
+  // |brackets|, and of every comma to |commas| when given. The positions are
+  // relative to the beginning of the input. The size of every part, except
+  // the last one, must be a multiple of 64 bytes.
+  void Scan(std::string_view part,
+            std::vector<uint64_t>& brackets,
+            std::vector<uint64_t>* commas = nullptr);
+
+  // Whether the input scanned so far ends inside a string.
+  bool in_string() const { return state_.string_carry != 0; }
+  const ScanState& state() const { return state_; }
+
+ private:
+  ScanKernel kernel_;
+  ScanState state_;
+};
+
+// Scan a whole input. Return false when it ends inside a string.
+bool ScanBrackets(std::string_view input,
+                  std::vector<uint64_t>& brackets,
+                  ScanKernel kernel = BestScanKernel());
+
+#endif  // JSON_TUI_STRUCTURAL_SCANNER_HPP
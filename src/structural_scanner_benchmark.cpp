@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include "structural_scanner.hpp"
+
+namespace {
+
+// A deterministic array of objects, mixing strings, escapes and numbers.
+std::string GenerateDocument(size_t size) {
+  std::string out = "[";
+  for (size_t i = 0; out.size() < size; ++i) {
+    if (i != 0)
+      out += ",";
+    out += R"({"id": )" + std::to_string(i) +
+           R"(, "name": "item \"[)" + std::to_string(i * 7919) +
+           R"(]\\", "tags": ["a", "b"], "value": )" +
+           std::to_string(i * 0.25) + "}";
+  }
+  out += "]";
+  return out;
+}
+
+const std::string& Document(size_t size) {
+  static std::string document;
+  if (document.size() < size)
+    document = GenerateDocument(size);
+  return document;
+}
+
+void BM_ScanBrackets(benchmark::State& state, ScanKernel kernel) {
+  if (!IsSupported(kernel)) {
+    state.SkipWithError("unsupported by this CPU");
+    return;
+  }
+  const std::string& input = Document(state.range(0));
+  std::vector<uint64_t> brackets;
+  for (auto _ : state) {
+    brackets.clear();
+    benchmark::DoNotOptimize(ScanBrackets(input, brackets, kernel));
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * input.size());
+}
+
+constexpr int64_t kSize = 64 << 20;
+
+BENCHMARK_CAPTURE(BM_ScanBrackets, Scalar, ScanKernel::Scalar)->Arg(kSize);
+BENCHMARK_CAPTURE(BM_ScanBrackets, SSE2, ScanKernel::SSE2)->Arg(kSize);
+BENCHMARK_CAPTURE(BM_ScanBrackets, AVX2, ScanKernel::AVX2)->Arg(kSize);
+
+}  // namespace
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <random>
+#include "structural_scanner.hpp"
+
+namespace {
+
+// A byte at a time reference.
+bool ScanBracketsReference(std::string_view input,
+                           std::vector<uint64_t>& brackets) {
+  bool in_string = false;
+  for (size_t i = 0; i < input.size(); ++i) {
+    const char c = input[i];
+    // Backslashes are invalid outside of strings. Like the scanner, let them
+    // escape the next character anyway.
+    if (c == '\\') {
+      i++;
+      continue;
+    }
+    if (in_string) {
+      if (c == '"')
+        in_string = false;
+      continue;
+    }
+    if (c == '"')
+      in_string = true;
+    else if (c == '{' || c == '}' || c == '[' || c == ']')
+      brackets.push_back(i);
+  }
+  return !in_string;
+}
+
+std::vector<ScanKernel> SupportedKernels() {
+  std::vector<ScanKernel> kernels;
+  for (auto kernel : {ScanKernel::Scalar, ScanKernel::SSE2, ScanKernel::AVX2}) {
+    if (IsSupported(kernel))
+      kernels.push_back(kernel);
+  }
+  return kernels;
+}
+
+void ExpectSameAsReference(std::string_view input) {
+  std::vector<uint64_t> expected;
+  const bool expected_closed = ScanBracketsReference(input, expected);
+  for (auto kernel : SupportedKernels()) {
+    std::vector<uint64_t> brackets;
+    EXPECT_EQ(ScanBrackets(input, brackets, kernel), expected_closed)
+        << "kernel " << int(kernel) << " input " << input;
+    EXPECT_EQ(brackets, expected)
+        << "kernel " << int(kernel) << " input " << input;
+  }
+}
+
+}  // namespace
+
+TEST(StructuralScanner, Simple) {
+  std::vector<uint64_t> brackets;
+  EXPECT_TRUE(ScanBrackets(R"({"a": [1, "]"], "b\"[": {}})", brackets));
+  EXPECT_EQ(brackets, (std::vector<uint64_t>{0, 6, 13, 24, 25, 26}));
+
+  brackets.clear();
+  EXPECT_FALSE(ScanBrackets(R"(["abc)", brackets));
+  EXPECT_EQ(brackets, (std::vector<uint64_t>{0}));
+}
+
+TEST(StructuralScanner, BlockBoundaries) {
+  // Move escape sequences and strings across the 64 bytes boundaries.
+  for (size_t padding = 0; padding < 130; ++padding) {
+    const std::string spaces(padding, ' ');
+    ExpectSameAsReference(spaces + R"(["a\\", "b\"]", "\\\"[", {}])");
+    ExpectSameAsReference(spaces + R"(["\\\\\\\\\\\\\\\\\\\\\\\\\\"] ])");
+    ExpectSameAsReference(spaces + "[\"" + std::string(100, '\\') + "\"]");
+    ExpectSameAsReference(spaces + "[\"" + std::string(101, '\\') + "\"]");
+    ExpectSameAsReference(spaces + "[\"");
+  }
+}
+
+TEST(StructuralScanner, Parts) {
+  const std::string input =
+      std::string(60, ' ') + R"(["\\\"", "\[", [{}]])" + std::string(70, ' ');
+  std::vector<uint64_t> expected;
+  ScanBracketsReference(input, expected);
+
+  for (auto kernel : SupportedKernels()) {
+    StructuralScanner scanner(kernel);
+    std::vector<uint64_t> brackets;
+    scanner.Scan(std::string_view(input).substr(0, 64), brackets);
+    EXPECT_TRUE(scanner.in_string());
+    scanner.Scan(std::string_view(input).substr(64), brackets);
+    EXPECT_FALSE(scanner.in_string());
+    EXPECT_EQ(brackets, expected);
+  }
+}
+
+TEST(StructuralScanner, Commas) {
+  const std::string input = R"([1, "a,b", "\\", "\",", {"c": [2,3]}] ,)";
+  for (auto kernel : SupportedKernels()) {
+    StructuralScanner scanner(kernel);
+    std::vector<uint64_t> brackets;
+    std::vector<uint64_t> commas;
+    scanner.Scan(input, brackets, &commas);
+    EXPECT_EQ(commas, (std::vector<uint64_t>{2, 9, 15, 22, 32, 38}));
+  }
+}
+
+TEST(StructuralScanner, Resume) {
+  const std::string input =
+      std::string(60, ' ') + R"(["\\\", ", 1, [{}]])" + std::string(70, ' ');
+  for (auto kernel : SupportedKernels()) {
+    StructuralScanner scanner(kernel);
+    std::vector<uint64_t> expected_brackets;
+    std::vector<uint64_t> expected_commas;
+    scanner.Scan(std::string_view(input).substr(0, 64), expected_brackets,
+                 &expected_commas);
+    const ScanState state = scanner.state();
+    EXPECT_EQ(state.position, 64u);
+    scanner.Scan(std::string_view(input).substr(64), expected_brackets,
+                 &expected_commas);
+    EXPECT_EQ(expected_commas, (std::vector<uint64_t>{69, 72}));
+
+    StructuralScanner resumed(state, kernel);
+    std::vector<uint64_t> brackets;
+    std::vector<uint64_t> commas;
+    resumed.Scan(std::string_view(input).substr(64), brackets, &commas);
+    EXPECT_EQ(brackets, (std::vector<uint64_t>(expected_brackets.begin() + 1,
+                                               expected_brackets.end())));
+    EXPECT_EQ(commas, expected_commas);
+  }
+}
+
+TEST(StructuralScanner, Random) {
+  std::mt19937 random(42);
+  const char alphabet[] = {'"', '\\', '[', ']', '{', '}', 'a', ' ', '\xC3'};
+  for (int i = 0; i < 2000; ++i) {
+    std::string input(random() % 300, ' ');
+    for (char& c : input)
+      c = alphabet[random() % sizeof(alphabet)];
+    ExpectSameAsReference(input);
+  }
+}